@@ -8,6 +8,8 @@
 #include "lib_heap.h"
 #include "lib_util.h"
 #include "lib_list.h"
+#include "lib_hash.h"
+#include "lib_ring.h"
 #include "lib_getopt.h"
 #include "lib_logs.h"
 #include "lib_rt.h"
@@ -0,0 +1,136 @@
+#include <lib.h>
+
+/**
+ * allocate and initialize a table of buckets
+ */
+static list_node_t * hash_alloc_buckets(uint32_t n)
+{
+   uint32_t i;
+   list_node_t * buckets = (list_node_t *)heap_alloc(n * sizeof(list_node_t));
+
+   if(buckets)
+   {
+      for(i = 0; i < n; i++)
+         list_init(&buckets[i]);
+   }
+   return buckets;
+}
+
+int hash_init(hash_table_t * table, int size)
+{
+   uint32_t n = 1;
+
+   while(n < (uint32_t)size)
+      n <<= 1;
+
+   table->count   = 0;
+   table->mask    = n - 1;
+   table->buckets = hash_alloc_buckets(n);
+
+   return table->buckets ? 0 : -1;
+}
+
+void hash_end(hash_table_t * table)
+{
+   heap_free(table->buckets);
+   table->buckets = NULL;
+   table->count   = 0;
+   table->mask    = 0;
+}
+
+/**
+ * double the number of buckets and move all nodes in their new bucket.
+ * The relative order of nodes having the same hash is kept.
+ * If memory is missing, the table keeps working with longer chains.
+ */
+static void hash_grow(hash_table_t * table)
+{
+   uint32_t i;
+   uint32_t n = (table->mask + 1) << 1;
+   list_node_t * buckets = hash_alloc_buckets(n);
+   list_node_t * node, * tmp;
+
+   if(buckets == NULL)
+      return;
+
+   for(i = 0; i <= table->mask; i++)
+   {
+      list_for_each_safe(node, tmp, &table->buckets[i])
+      {
+         hash_node_t * h = (hash_node_t *)node;
+         list_add_tail(&h->node, &buckets[h->hash & (n - 1)]);
+      }
+   }
+
+   heap_free(table->buckets);
+   table->buckets = buckets;
+   table->mask    = n - 1;
+}
+
+void hash_insert(hash_table_t * table, hash_node_t * node, uint32_t hash)
+{
+   if(table->count > table->mask)
+      hash_grow(table);
+
+   node->hash = hash;
+   list_add_tail(&node->node, hash_bucket(table, hash));
+   table->count++;
+}
+
+void hash_insert_sorted(hash_table_t * table, hash_node_t * node, uint32_t hash,
+                        int (*before)(hash_node_t * a, hash_node_t * b))
+{
+   list_node_t * pos;
+   list_node_t * bucket;
+
+   if(table->count > table->mask)
+      hash_grow(table);
+
+   node->hash = hash;
+   bucket = hash_bucket(table, hash);
+
+   list_for_each_rev(pos, bucket)
+   {
+      hash_node_t * h = (hash_node_t *)pos;
+      if((h->hash == hash) && before(h, node))
+         break;
+   }
+
+   // pos is either the last node that precedes the new one, or the bucket head
+   list_insert_after(&node->node, pos);
+   table->count++;
+}
+
+void hash_delete(hash_table_t * table, hash_node_t * node)
+{
+   if(list_empty(&node->node))
+      return;
+
+   list_delete(&node->node);
+   list_init(&node->node);
+   table->count--;
+}
+
+uint32_t hash_string(const char * str)
+{
+   uint32_t h = 2166136261u;
+
+   while(*str)
+   {
+      h ^= (unsigned char)*str++;
+      h *= 16777619u;
+   }
+   return h;
+}
+
+uint64_t hash_data(uint64_t h, const void * data, size_t len)
+{
+   const unsigned char * p = (const unsigned char *)data;
+
+   while(len--)
+   {
+      h ^= *p++;
+      h *= 1099511628211ull;
+   }
+   return h;
+}
@@ -0,0 +1,170 @@
+#ifndef LIB_HASH_H
+#define LIB_HASH_H
+
+#include <cpu.h>
+
+#include <lib_list.h>
+
+/**
+ * \addtogroup PAL
+ * @{
+ * \addtogroup LIB
+ * @{
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/**
+ * \addtogroup hash
+ * @{
+ */
+
+/**
+ * Hash table node.
+ * Insert it in your structure, like a list_node, then the structure can be indexed by a hash table.
+ * The hash value is kept in the node so that the table can grow without knowing the key.
+ */
+typedef struct hash_node
+{
+   list_node_t  node;
+   uint32_t     hash;
+}
+hash_node_t;
+
+/**
+ * Hash table of intrusive nodes, chained in buckets. The number of buckets is a power of 2 and
+ * doubles each time the number of nodes exceeds it.
+ */
+typedef struct hash_table
+{
+   list_node_t * buckets;
+   uint32_t      mask;     /// number of buckets - 1
+   uint32_t      count;    /// number of inserted nodes
+}
+hash_table_t;
+
+/**
+ * Initialize a hash table
+ * @param[in] table
+ * @param[in] size initial number of buckets, rounded to the upper power of 2
+ * @return 0 (OK) or -1
+ */
+int      hash_init(hash_table_t * table, int size);
+
+/**
+ * Release buckets of a hash table. Nodes are not freed.
+ * @param[in] table
+ */
+void     hash_end(hash_table_t * table);
+
+/**
+ * Add a node in the table, at the tail of its bucket.
+ * @param[in] table
+ * @param[in] node  node to insert
+ * @param[in] hash  hash value of the key
+ */
+void     hash_insert(hash_table_t * table, hash_node_t * node, uint32_t hash);
+
+/**
+ * Add a node in the table, keeping nodes of the same hash value ordered.
+ * The bucket is scanned from its tail, so that inserting nodes in almost sorted order is cheap.
+ * @param[in] table
+ * @param[in] node   node to insert
+ * @param[in] hash   hash value of the key
+ * @param[in] before return 1 if its first node must be placed before its second one
+ */
+void     hash_insert_sorted(hash_table_t * table, hash_node_t * node, uint32_t hash,
+                            int (*before)(hash_node_t * a, hash_node_t * b));
+
+/**
+ * Remove a node from its table. Removing a node twice has no effect.
+ * @param[in] table
+ * @param[in] node
+ */
+void     hash_delete(hash_table_t * table, hash_node_t * node);
+
+/**
+ * Mark a node as not being part of any table
+ * @param[in] node
+ */
+static inline void hash_node_init(hash_node_t * node)
+{
+   list_init(&node->node);
+}
+
+/**
+ * Return the bucket list that may contain a key with this hash
+ */
+static inline list_node_t * hash_bucket(hash_table_t * table, uint32_t hash)
+{
+   return &table->buckets[hash & table->mask];
+}
+
+/**
+ * Iterate over all nodes that may match a given hash value. The caller must still compare the key.
+ * WARNING: do not remove any node while doing the loop !
+ * @pos:   the hash_node_t * to use as a loop cursor.
+ * @table: the hash table.
+ * @h:     the hash value to look for.
+ */
+#define hash_for_each(pos, table, h)                                                       \
+   for (pos = (hash_node_t *)hash_bucket(table, h)->pnext;                                 \
+        &pos->node != hash_bucket(table, h);                                               \
+        pos = (hash_node_t *)pos->node.pnext)                                              \
+      if (pos->hash != (h))                                                                \
+         continue;                                                                         \
+      else
+
+/**
+ * Get the struct for this hash node
+ */
+#define hash_entry(ptr, type, member) \
+   container_of(ptr, type, member)
+
+/**
+ * hash of an integer key
+ */
+static inline uint32_t hash_u64(uint64_t key)
+{
+   key ^= key >> 33;
+   key *= 0xff51afd7ed558ccdULL;
+   key ^= key >> 33;
+   key *= 0xc4ceb9fe1a85ec53ULL;
+   key ^= key >> 33;
+   return (uint32_t)key;
+}
+
+/**
+ * combine two hash values
+ */
+static inline uint32_t hash_combine(uint32_t h1, uint32_t h2)
+{
+   return h1 ^ (h2 + 0x9e3779b9 + (h1 << 6) + (h1 >> 2));
+}
+
+/**
+ * hash of a null terminated string (FNV-1a)
+ */
+uint32_t hash_string(const char * str);
+
+/**
+ * initial value of @ref hash_data
+ */
+#define HASH_DATA_INIT 14695981039346656037ull
+
+/**
+ * 64 bits hash of a block of data (FNV-1a). Blocks are chained by passing the hash of the previous blocks in h,
+ * starting from HASH_DATA_INIT
+ */
+uint64_t hash_data(uint64_t h, const void * data, size_t len);
+
+/**@} hash */
+#ifdef __cplusplus
+}
+#endif
+
+/* @} LIB
+ * @} PAL */
+
+#endif
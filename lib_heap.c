@@ -1,6 +1,7 @@
 #include <lib.h>
 #include <stdlib.h>
 #include <malloc.h>
+#include <stdio.h>
 
 int heap_init(void)
 {
@@ -44,3 +45,109 @@ int heap_check()
 }
 
 
+/**
+ * header of a slab, followed by its blocks
+ */
+struct heap_slab
+{
+   struct heap_slab * next;
+   size_t             pad;   // keep blocks aligned on 2 words
+};
+
+heap_pool_t* heap_pool_create(const char * name, size_t size, int per_slab)
+{
+   heap_pool_t * pool = (heap_pool_t *)heap_alloc(sizeof(heap_pool_t));
+
+   if(pool == NULL)
+      return NULL;
+
+   // a free block holds the pointer towards the next free block
+   if(size < sizeof(void *))
+      size = sizeof(void *);
+
+   pool->name       = name;
+   pool->size       = (size + 2 * sizeof(void *) - 1) & ~(2 * sizeof(void *) - 1);
+   pool->per_slab   = (per_slab > 0) ? per_slab : 1;
+   pool->free       = NULL;
+   pool->slabs      = NULL;
+   pool->slab_count = 0;
+   pool->used       = 0;
+   pool->used_max   = 0;
+   pool->allocs     = 0;
+
+   return pool;
+}
+
+/**
+ * allocate a new slab, and add all its blocks to the free list
+ */
+static int heap_pool_grow(heap_pool_t * pool)
+{
+   int i;
+   char * block;
+   struct heap_slab * slab = (struct heap_slab *)heap_alloc(sizeof(struct heap_slab) + pool->size * pool->per_slab);
+
+   if(slab == NULL)
+      return -1;
+
+   slab->next  = (struct heap_slab *)pool->slabs;
+   pool->slabs = slab;
+   pool->slab_count++;
+
+   // chain blocks so that they are allocated in address order
+   block = (char *)(slab + 1) + pool->size * (pool->per_slab - 1);
+   for(i = 0; i < pool->per_slab; i++)
+   {
+      *(void **)block = pool->free;
+      pool->free = block;
+      block -= pool->size;
+   }
+   return 0;
+}
+
+void* heap_pool_alloc(heap_pool_t * pool)
+{
+   void * ptr;
+
+   if((pool->free == NULL) && (heap_pool_grow(pool) < 0))
+      return NULL;
+
+   ptr = pool->free;
+   pool->free = *(void **)ptr;
+
+   pool->allocs++;
+   if(++pool->used > pool->used_max)
+      pool->used_max = pool->used;
+
+   return ptr;
+}
+
+void heap_pool_free(heap_pool_t * pool, void * ptr)
+{
+   if(ptr == NULL)
+      return;
+
+   *(void **)ptr = pool->free;
+   pool->free = ptr;
+   pool->used--;
+}
+
+void heap_pool_destroy(heap_pool_t * pool)
+{
+   struct heap_slab * slab = (struct heap_slab *)pool->slabs;
+
+   while(slab)
+   {
+      struct heap_slab * next = slab->next;
+      heap_free(slab);
+      slab = next;
+   }
+   heap_free(pool);
+}
+
+void heap_pool_dump(heap_pool_t * pool)
+{
+   printf("pool %-16s: block %4d bytes, %d slabs of %d blocks, used %d, max %d, %llu allocations\n",
+          pool->name, (int)pool->size, pool->slab_count, pool->per_slab, pool->used, pool->used_max,
+          (unsigned long long)pool->allocs);
+}
@@ -77,6 +77,66 @@ void         heap_dump(void);
  */
 int          heap_check();
 
+/**
+ * Pool of fixed size blocks.
+ * Blocks are carved from slabs of several blocks, and freed blocks are kept in a free list, so that
+ * allocating or freeing a block is a single list operation. Slabs are only released by @ref heap_pool_destroy.
+ */
+typedef struct heap_pool
+{
+   const char * name;       /// name of the pool, for statistics
+   size_t       size;       /// size of a block, rounded to keep blocks aligned
+   int          per_slab;   /// number of blocks per slab
+   void *       free;       /// list of free blocks
+   void *       slabs;      /// list of allocated slabs
+   int          slab_count; /// number of allocated slabs
+   int          used;       /// number of blocks in use
+   int          used_max;   /// maximum number of blocks in use
+   uint64_t     allocs;     /// number of allocations
+}
+heap_pool_t;
+
+/**
+ * create a pool of blocks
+ * @param[in] name     name of the pool, displayed by @ref heap_pool_dump
+ * @param[in] size     size of a block in bytes
+ * @param[in] per_slab number of blocks allocated at once when the pool is empty
+ * @return the pool, or NULL
+ */
+heap_pool_t* heap_pool_create(const char * name, size_t size, int per_slab);
+
+/**
+ * allocate one block
+ * @pre @ref heap_pool_create
+ * @param[in] pool
+ * @return pointer towards allocated block, or NULL
+ */
+void*        heap_pool_alloc(heap_pool_t * pool);
+
+/**
+ * give back a block to its pool
+ * @pre @ref heap_pool_alloc
+ * @param[in] pool
+ * @param[in] ptr block allocated in this pool (NULL is accepted)
+ * @return none
+ */
+void         heap_pool_free(heap_pool_t * pool, void * ptr);
+
+/**
+ * release all slabs of a pool, and the pool itself
+ * @pre @ref heap_pool_create
+ * @param[in] pool
+ * @return none
+ */
+void         heap_pool_destroy(heap_pool_t * pool);
+
+/**
+ * Dump statistics of a pool on stdout
+ * @param[in] pool
+ * @return none
+ */
+void         heap_pool_dump(heap_pool_t * pool);
+
 #ifdef __cplusplus
 }
 #endif
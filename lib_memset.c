@@ -19,3 +19,8 @@ int mem_cmp(const void *s1, const void *s2, size_t n)
 {
    return memcmp(s1, s2, n);
 }
+
+void * mem_chr(const void *s, int c, size_t n)
+{
+   return memchr(s, c, n);
+}
@@ -55,6 +55,15 @@ void       * mem_move(void *dest, const void *src, size_t n);
 
 int          mem_cmp(const void *s1, const void *s2, size_t n);
 
+/**
+ * find a byte in part of memory
+ * @param[in] s memory to scan
+ * @param[in] c byte to find
+ * @param[in] n number of bytes to scan
+ * @return ptr towards the first c byte, or NULL
+ */
+void       * mem_chr(const void *s, int c, size_t n);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,26 @@
+#include <lib.h>
+
+int ring_init(ring_t * ring, int size, int elem)
+{
+   uint32_t n = 1;
+
+   while(n < (uint32_t)size)
+      n <<= 1;
+
+   ring->mask  = n - 1;
+   ring->elem  = elem;
+   ring->head  = 0;
+   ring->tail  = 0;
+   ring->slots = (char *)heap_alloc((size_t)n * elem);
+
+   return ring->slots ? 0 : -1;
+}
+
+void ring_end(ring_t * ring)
+{
+   heap_free(ring->slots);
+   ring->slots = NULL;
+   ring->mask  = 0;
+   ring->head  = 0;
+   ring->tail  = 0;
+}
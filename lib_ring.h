@@ -0,0 +1,112 @@
+#ifndef LIB_RING_H
+#define LIB_RING_H
+
+#include <cpu.h>
+
+/**
+ * \addtogroup PAL
+ * @{
+ * \addtogroup LIB
+ * @{
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/**
+ * \addtogroup ring
+ * @{
+ */
+
+/**
+ * Lock free ring of fixed size elements, between one producer thread and one consumer thread.
+ * Elements are written and read in place: the producer gets a free slot, fills it, then commits it. The consumer
+ * gets the oldest committed slot, uses it, then releases it.
+ */
+typedef struct ring
+{
+   char *       slots;
+   uint32_t     mask;      /// number of slots - 1
+   uint32_t     elem;      /// size of a slot
+   uint32_t     head;      /// number of committed slots, written by the producer only
+   uint32_t     tail;      /// number of released slots, written by the consumer only
+}
+ring_t;
+
+/**
+ * Initialize a ring
+ * @param[in] ring
+ * @param[in] size number of slots, rounded to the upper power of 2
+ * @param[in] elem size of a slot
+ * @return 0 (OK) or -1
+ */
+int      ring_init(ring_t * ring, int size, int elem);
+
+/**
+ * Release the slots of a ring
+ * @param[in] ring
+ */
+void     ring_end(ring_t * ring);
+
+/**
+ * Return the next free slot of the producer, or NULL if the ring is full
+ * @param[in] ring
+ */
+static inline void * ring_push_slot(ring_t * ring)
+{
+   uint32_t head = ring->head;
+
+   if(head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) > ring->mask)
+      return NULL;
+   return ring->slots + (head & ring->mask) * ring->elem;
+}
+
+/**
+ * Make the slot returned by @ref ring_push_slot visible to the consumer
+ * @param[in] ring
+ */
+static inline void ring_push_commit(ring_t * ring)
+{
+   __atomic_store_n(&ring->head, ring->head + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Return the oldest committed slot, or NULL if the ring is empty
+ * @param[in] ring
+ */
+static inline void * ring_pop_slot(ring_t * ring)
+{
+   uint32_t tail = ring->tail;
+
+   if(__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) == tail)
+      return NULL;
+   return ring->slots + (tail & ring->mask) * ring->elem;
+}
+
+/**
+ * Give back the slot returned by @ref ring_pop_slot to the producer
+ * @param[in] ring
+ */
+static inline void ring_pop_commit(ring_t * ring)
+{
+   __atomic_store_n(&ring->tail, ring->tail + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Return the number of committed slots not released yet, seen by the consumer
+ * @param[in] ring
+ */
+static inline uint32_t ring_count(ring_t * ring)
+{
+   return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - ring->tail;
+}
+
+/**@} ring */
+#ifdef __cplusplus
+}
+#endif
+
+/* @} LIB
+ * @} PAL */
+
+#endif
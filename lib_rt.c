@@ -269,8 +269,11 @@ int rt_msg_from_buf(char * buf, int len, rt_cmd_t * cmd, rt_time_t * time, objec
    buf += sz;
 
    len -= min;
+   if(len > RT_CFG_MAX_TEXT_LEN - 1)
+      len = RT_CFG_MAX_TEXT_LEN - 1;
 
    string_ncpy(text, buf, len);
+   text[len] = '\0';
 
    return 0;
 }
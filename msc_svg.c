@@ -0,0 +1,727 @@
+#include <lib.h>
+#include <msc_svg.h>
+
+/**
+ * configuration of logs for this file
+ */
+#define _DEF__LOG_NAME     "SVG"
+#define _DEF__LOG_LEVEL    DEBUG_VERB
+#define _DEF__LOG_COLOR    COLOR_LIGHT_BLUE
+#define _DEF__LOG_OUTPUT   LOG_DEF_USER
+
+#include <lib_set_logs.h>
+
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <stdarg.h>
+
+/**
+ * page margin, and height of the page title, in mm
+ */
+#define SVG_MARGIN   10.0
+#define SVG_TITLE    6.0
+
+/**
+ * height of instance feet, in mm
+ */
+#define SVG_FOOT     3.0
+
+/**
+ * width of regions, and size of timer symbols, in mm
+ */
+#define SVG_REGION   3.0
+#define SVG_SYMBOL   2.0
+
+/**
+ * growing text buffer
+ */
+struct svg_buf
+{
+   char * data;
+   int    len;
+   int    max;
+};
+
+/**
+ * column of an instance in the current page
+ */
+struct svg_inst
+{
+   hash_node_t        node;       /// in svg.index, keyed by id
+   const void       * id;
+   int                col;        /// column, from 0 at the left
+   int                drawn;      /// 1 once its head is drawn
+   double             top;        /// y of the bottom of its head
+   int                stopped;    /// 1 once stopped
+   double             bottom;     /// y where its line ends when stopped
+   int                region;     /// kind of the open region, or -1
+   int                region_level;
+};
+
+/**
+ * renderer state
+ */
+static struct
+{
+   int                enabled;
+   char               dir[RT_CFG_MAX_TEXT_LEN];
+   double             level_height;
+   double             box_height;
+   double             inst_dist;
+
+   int                page;       /// number of written pages
+   int                open;       /// 1 between svg_page_start and svg_page_end
+   char               title[RT_CFG_MAX_TEXT_LEN];
+   int                level;      /// current level in the page
+   int                max_level;  /// lowest level reached in the page
+
+   struct svg_inst ** insts;      /// instances of the page, by column
+   int                count;
+   int                max;
+   hash_table_t       index;
+
+   struct svg_buf     back;       /// heads, regions and stops, drawn over instance lines
+   struct svg_buf     front;      /// messages and other events
+}
+svg;
+
+/*-----------------------------------------------------------------------------------------
+ * text buffers
+ *---------------------------------------------------------------------------------------*/
+
+/**
+ * make room for n more bytes in a buffer
+ * return -1 if memory is missing, 0 otherwise
+ */
+static int buf_reserve(struct svg_buf * b, int n)
+{
+   char * data;
+   int max = b->max ? b->max : 4096;
+
+   if(b->len + n < b->max)
+      return 0;
+
+   while(b->len + n >= max)
+      max *= 2;
+
+   data = (char *)heap_realloc(b->data, max);
+   if(data == NULL)
+      return -1;
+
+   b->data = data;
+   b->max  = max;
+   return 0;
+}
+
+static void buf_printf(struct svg_buf * b, const char * format, ...)
+{
+   va_list args;
+   int n;
+
+   va_start(args, format);
+   n = string_vnprintf(b->data + b->len, b->max - b->len, format, args);
+   va_end(args);
+
+   if((n >= b->max - b->len) || (b->data == NULL))
+   {
+      if(buf_reserve(b, n + 1) < 0)
+         return;
+      va_start(args, format);
+      n = string_vnprintf(b->data + b->len, b->max - b->len, format, args);
+      va_end(args);
+   }
+   b->len += n;
+}
+
+/**
+ * add a text, escaped for xml. Texts are written for the msc latex document: the latex escapes of special
+ * characters are shown as the characters. Control characters, not allowed in xml, are shown as spaces.
+ */
+static void buf_text(struct svg_buf * b, const char * str)
+{
+   unsigned char c;
+
+   for(; *str; str++)
+   {
+      c = (unsigned char)*str;
+      if((c == '\\') && (str[1] != '\0') && string_chr("_%&#${}", str[1]))
+         c = (unsigned char)*++str;
+
+      switch(c)
+      {
+         case '&': buf_printf(b, "&amp;");  break;
+         case '<': buf_printf(b, "&lt;");   break;
+         case '>': buf_printf(b, "&gt;");   break;
+         case '"': buf_printf(b, "&quot;"); break;
+         default:
+            if(buf_reserve(b, 2) == 0)
+               b->data[b->len++] = (c < 0x20) ? ' ' : (char)c;
+            break;
+      }
+   }
+}
+
+/**
+ * add a text element
+ */
+static void buf_label(struct svg_buf * b, double x, double y, const char * anchor, const char * str)
+{
+   if((str == NULL) || (*str == '\0'))
+      return;
+
+   buf_printf(b, "<text x=\"%.1f\" y=\"%.1f\" text-anchor=\"%s\">", x, y, anchor);
+   buf_text(b, str);
+   buf_printf(b, "</text>\n");
+}
+
+static void buf_line(struct svg_buf * b, double x1, double y1, double x2, double y2, const char * style)
+{
+   buf_printf(b, "<line x1=\"%.1f\" y1=\"%.1f\" x2=\"%.1f\" y2=\"%.1f\" %s/>\n", x1, y1, x2, y2, style);
+}
+
+/*-----------------------------------------------------------------------------------------
+ * geometry
+ *---------------------------------------------------------------------------------------*/
+
+static double svg_x(int col)
+{
+   return SVG_MARGIN + (col + 1) * svg.inst_dist;
+}
+
+static double svg_y(int level)
+{
+   return SVG_MARGIN + SVG_TITLE + svg.level_height + 2 * svg.box_height + level * svg.level_height;
+}
+
+static double svg_head_width()
+{
+   return 0.8 * svg.inst_dist;
+}
+
+/**
+ * return the instance of an id in the current page, or NULL
+ */
+static struct svg_inst * svg_find(const void * id)
+{
+   hash_node_t * pos;
+   uint32_t h = hash_u64((uintptr_t)id);
+
+   if(!svg.open)
+      return NULL;
+
+   hash_for_each(pos, &svg.index, h)
+   {
+      struct svg_inst * inst = hash_entry(pos, struct svg_inst, node);
+      if(inst->id == id)
+         return inst;
+   }
+   return NULL;
+}
+
+/**
+ * add a column for an id in the current page
+ */
+static struct svg_inst * svg_add(const void * id)
+{
+   struct svg_inst * inst = svg_find(id);
+
+   if(inst || !svg.open)
+      return inst;
+
+   if(svg.count == svg.max)
+   {
+      int max = svg.max ? 2 * svg.max : 16;
+      struct svg_inst ** insts = (struct svg_inst **)heap_realloc(svg.insts, max * sizeof(struct svg_inst *));
+      if(insts == NULL)
+         return NULL;
+      svg.insts = insts;
+      svg.max   = max;
+   }
+
+   inst = (struct svg_inst *)heap_alloc(sizeof(struct svg_inst));
+   if(inst == NULL)
+      return NULL;
+
+   inst->id      = id;
+   inst->col     = svg.count;
+   inst->drawn   = 0;
+   inst->top     = 0;
+   inst->stopped = 0;
+   inst->bottom  = 0;
+   inst->region  = -1;
+   hash_insert(&svg.index, &inst->node, hash_u64((uintptr_t)id));
+   svg.insts[svg.count++] = inst;
+   return inst;
+}
+
+/**
+ * draw an instance head, centered on y
+ */
+static void svg_head(struct svg_inst * inst, double y, const char * above, const char * name)
+{
+   double x = svg_x(inst->col);
+   double w = svg_head_width();
+   double h = svg.box_height;
+
+   buf_printf(&svg.back, "<rect x=\"%.1f\" y=\"%.1f\" width=\"%.1f\" height=\"%.1f\" fill=\"white\" stroke=\"black\"/>\n",
+              x - w / 2, y - h / 2, w, h);
+   buf_label(&svg.back, x, y - h / 2 - 1, "middle", above);
+   buf_label(&svg.back, x, y + 1, "middle", name);
+
+   inst->drawn = 1;
+   inst->top   = y + h / 2;
+}
+
+/**
+ * draw the region of an instance, from its start to y
+ */
+static void svg_region_draw(struct svg_inst * inst, double y2)
+{
+   static const char * style[] =
+   {
+      [SVG_REGION_ACTIVATION] = "fill=\"#d0d0d0\" stroke=\"black\"",
+      [SVG_REGION_COREGION]   = "fill=\"none\" stroke=\"black\" stroke-dasharray=\"1,1\"",
+      [SVG_REGION_SUSPENSION] = "fill=\"white\" stroke=\"black\" stroke-dasharray=\"2,1\"",
+   };
+   double y1 = svg_y(inst->region_level);
+
+   if(inst->region < 0)
+      return;
+
+   if(y1 < inst->top)
+      y1 = inst->top;
+   if(y2 > y1)
+   {
+      buf_printf(&svg.back, "<rect x=\"%.1f\" y=\"%.1f\" width=\"%.1f\" height=\"%.1f\" %s/>\n",
+                 svg_x(inst->col) - SVG_REGION / 2, y1, SVG_REGION, y2 - y1, style[inst->region]);
+   }
+   inst->region = -1;
+}
+
+static void svg_cross(struct svg_buf * b, double x, double y)
+{
+   buf_line(b, x - SVG_SYMBOL, y - SVG_SYMBOL, x + SVG_SYMBOL, y + SVG_SYMBOL, "stroke=\"black\"");
+   buf_line(b, x - SVG_SYMBOL, y + SVG_SYMBOL, x + SVG_SYMBOL, y - SVG_SYMBOL, "stroke=\"black\"");
+}
+
+static void svg_hourglass(struct svg_buf * b, double x, double y)
+{
+   buf_printf(b, "<path d=\"M%.1f,%.1f L%.1f,%.1f L%.1f,%.1f L%.1f,%.1f z\" fill=\"white\" stroke=\"black\"/>\n",
+              x - SVG_SYMBOL, y - SVG_SYMBOL, x + SVG_SYMBOL, y + SVG_SYMBOL,
+              x - SVG_SYMBOL, y + SVG_SYMBOL, x + SVG_SYMBOL, y - SVG_SYMBOL);
+}
+
+static void svg_reach(int level)
+{
+   if(level > svg.max_level)
+      svg.max_level = level;
+}
+
+/*-----------------------------------------------------------------------------------------
+ * document
+ *---------------------------------------------------------------------------------------*/
+
+int svg_open(const char * dir, int level_height, int box_height, int inst_dist)
+{
+   if((mkdir(dir, 0777) < 0) && (access(dir, W_OK) < 0))
+      return -1;
+
+   if(hash_init(&svg.index, 64) < 0)
+      return -1;
+
+   string_ncpy(svg.dir, dir, sizeof(svg.dir) - 1);
+   svg.dir[sizeof(svg.dir) - 1] = '\0';
+   svg.level_height = level_height;
+   svg.box_height   = box_height;
+   svg.inst_dist    = inst_dist;
+   svg.page         = 0;
+   svg.open         = 0;
+   svg.enabled      = 1;
+   return 0;
+}
+
+void svg_close(void)
+{
+   if(!svg.enabled)
+      return;
+
+   if(svg.open)
+      svg_page_end();
+
+   heap_free(svg.insts);
+   heap_free(svg.back.data);
+   heap_free(svg.front.data);
+   hash_end(&svg.index);
+   mem_set(&svg, 0, sizeof(svg));
+}
+
+int svg_enabled(void)
+{
+   return svg.enabled;
+}
+
+void svg_page_start(const char * title)
+{
+   if(!svg.enabled)
+      return;
+
+   if(svg.open)
+      svg_page_end();
+
+   string_ncpy(svg.title, title, sizeof(svg.title) - 1);
+   svg.title[sizeof(svg.title) - 1] = '\0';
+   svg.open      = 1;
+   svg.level     = 0;
+   svg.max_level = 0;
+   svg.back.len  = 0;
+   svg.front.len = 0;
+}
+
+void svg_page_end(void)
+{
+   struct svg_buf head = { NULL, 0, 0 };
+   char path[RT_CFG_MAX_TEXT_LEN + 32];
+   double foot, width, height, x;
+   int i, fd;
+
+   if(!svg.open)
+      return;
+
+   svg_reach(svg.level);
+   foot   = svg_y(svg.max_level) + svg.box_height;
+   width  = 2 * SVG_MARGIN + (svg.count + 1) * svg.inst_dist;
+   height = foot + SVG_FOOT + svg.level_height + SVG_MARGIN;
+
+   buf_printf(&head, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+   buf_printf(&head, "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%.0fmm\" height=\"%.0fmm\" viewBox=\"0 0 %.1f %.1f\""
+                     " font-family=\"sans-serif\" font-size=\"3\" stroke-width=\"0.3\">\n", width, height, width, height);
+   buf_printf(&head, "<defs><marker id=\"arrow\" viewBox=\"0 0 10 10\" refX=\"10\" refY=\"5\" markerWidth=\"5\" markerHeight=\"5\""
+                     " orient=\"auto\"><path d=\"M0,0 L10,5 L0,10 z\"/></marker></defs>\n");
+   buf_printf(&head, "<rect width=\"100%%\" height=\"100%%\" fill=\"white\"/>\n");
+   buf_printf(&head, "<rect x=\"%.1f\" y=\"%.1f\" width=\"%.1f\" height=\"%.1f\" fill=\"none\" stroke=\"black\"/>\n",
+              SVG_MARGIN, SVG_MARGIN, width - 2 * SVG_MARGIN, height - 2 * SVG_MARGIN);
+   buf_printf(&head, "<text x=\"%.1f\" y=\"%.1f\" font-weight=\"bold\">msc ", SVG_MARGIN + 2, SVG_MARGIN + SVG_TITLE - 2);
+   buf_text(&head, svg.title);
+   buf_printf(&head, "</text>\n");
+
+   // instance lines, then their feet. Open regions end at the foot
+   for(i = 0; i < svg.count; i++)
+   {
+      struct svg_inst * inst = svg.insts[i];
+      if(!inst->drawn)
+         continue;
+
+      x = svg_x(inst->col);
+      buf_line(&head, x, inst->top, x, inst->stopped ? inst->bottom : foot, "stroke=\"black\"");
+      if(!inst->stopped)
+      {
+         buf_printf(&head, "<rect x=\"%.1f\" y=\"%.1f\" width=\"%.1f\" height=\"%.1f\"/>\n",
+                    x - svg_head_width() / 2, foot, svg_head_width(), SVG_FOOT);
+         svg_region_draw(inst, foot);
+      }
+   }
+
+   string_printf(path, "%s/page_%04d.svg", svg.dir, svg.page);
+   fd = open(path, O_CREAT|O_WRONLY|O_TRUNC, 0666);
+   if(fd >= 0)
+   {
+      if((write(fd, head.data, head.len) != head.len) ||
+         (svg.back.len && (write(fd, svg.back.data, svg.back.len) != svg.back.len)) ||
+         (svg.front.len && (write(fd, svg.front.data, svg.front.len) != svg.front.len)) ||
+         (write(fd, "</svg>\n", 7) != 7))
+      {
+         close(fd);
+         fd = -1;
+      }
+      else
+      {
+         close(fd);
+      }
+   }
+   if(fd < 0)
+      ERROR("Cannot write %s\n", path);
+
+   heap_free(head.data);
+   for(i = 0; i < svg.count; i++)
+   {
+      hash_delete(&svg.index, &svg.insts[i]->node);
+      heap_free(svg.insts[i]);
+   }
+   svg.count = 0;
+   svg.open  = 0;
+   svg.page++;
+}
+
+void svg_nextlevel(int n)
+{
+   if(!svg.open)
+      return;
+
+   svg.level += n;
+   svg_reach(svg.level);
+}
+
+void svg_mark(int top, const char * text)
+{
+   double y = svg_y(svg.level);
+
+   if(!svg.open)
+      return;
+
+   buf_line(&svg.front, SVG_MARGIN, y, SVG_MARGIN + 3, y, "stroke=\"black\"");
+   buf_label(&svg.front, SVG_MARGIN + 1, top ? y - 1 : y + 3, "start", text);
+}
+
+/*-----------------------------------------------------------------------------------------
+ * instances
+ *---------------------------------------------------------------------------------------*/
+
+void svg_declinst(const void * id, const char * above, const char * name)
+{
+   struct svg_inst * inst = svg_add(id);
+
+   if((inst == NULL) || inst->drawn)
+      return;
+
+   svg_head(inst, SVG_MARGIN + SVG_TITLE + svg.level_height + svg.box_height / 2, above, name);
+}
+
+void svg_dummyinst(const void * id)
+{
+   svg_add(id);
+}
+
+void svg_create(const char * label, const void * creator, const void * id, const char * above, const char * name)
+{
+   struct svg_inst * from = svg_find(creator);
+   struct svg_inst * inst = svg_add(id);
+   double y = svg_y(svg.level);
+   double x1, x2;
+
+   if((inst == NULL) || inst->drawn)
+      return;
+
+   svg_head(inst, y, above, name);
+   if(from == NULL)
+      return;
+
+   x1 = svg_x(from->col);
+   x2 = svg_x(inst->col) + ((x1 < svg_x(inst->col)) ? -1 : 1) * svg_head_width() / 2;
+   buf_line(&svg.front, x1, y, x2, y, "stroke=\"black\" stroke-dasharray=\"2,1\" marker-end=\"url(#arrow)\"");
+   buf_label(&svg.front, (x1 + x2) / 2, y - 1, "middle", label);
+}
+
+void svg_stop(const void * id)
+{
+   struct svg_inst * inst = svg_find(id);
+
+   if((inst == NULL) || !inst->drawn || inst->stopped)
+      return;
+
+   svg_region_draw(inst, svg_y(svg.level));
+   inst->stopped = 1;
+   inst->bottom  = svg_y(svg.level);
+   svg_cross(&svg.back, svg_x(inst->col), inst->bottom);
+}
+
+void svg_region_start(const void * id, int kind)
+{
+   struct svg_inst * inst = svg_find(id);
+
+   if(inst == NULL)
+      return;
+
+   svg_region_draw(inst, svg_y(svg.level));
+   inst->region       = kind;
+   inst->region_level = svg.level;
+}
+
+void svg_region_end(const void * id)
+{
+   struct svg_inst * inst = svg_find(id);
+
+   if(inst)
+      svg_region_draw(inst, svg_y(svg.level));
+}
+
+/*-----------------------------------------------------------------------------------------
+ * events
+ *---------------------------------------------------------------------------------------*/
+
+void svg_mess(const char * text, const void * from, const void * to, int off, int dashed)
+{
+   struct svg_inst * a = svg_find(from);
+   struct svg_inst * b = svg_find(to);
+   double x1, x2, y1, y2;
+
+   if((a == NULL) || (b == NULL))
+      return;
+
+   x1 = svg_x(a->col);
+   x2 = svg_x(b->col);
+   y1 = svg_y(svg.level);
+   y2 = svg_y(svg.level + off);
+   svg_reach(svg.level + off);
+
+   if(a == b)
+   {
+      // message to itself: loop at the right of the instance
+      buf_printf(&svg.front, "<path d=\"M%.1f,%.1f h%.1f V%.1f H%.1f\" fill=\"none\" stroke=\"black\"%s marker-end=\"url(#arrow)\"/>\n",
+                 x1, y1, svg.inst_dist / 4, (y2 > y1) ? y2 : y1 + svg.level_height / 2, x1,
+                 dashed ? " stroke-dasharray=\"2,1\"" : "");
+      buf_label(&svg.front, x1 + svg.inst_dist / 4 + 1, y1 + 1, "start", text);
+      return;
+   }
+
+   buf_line(&svg.front, x1, y1, x2, y2, dashed ? "stroke=\"black\" stroke-dasharray=\"2,1\" marker-end=\"url(#arrow)\""
+                                               : "stroke=\"black\" marker-end=\"url(#arrow)\"");
+   buf_label(&svg.front, (x1 + x2) / 2, (y1 + y2) / 2 - 1, "middle", text);
+}
+
+void svg_lost(const char * text, const void * id)
+{
+   struct svg_inst * inst = svg_find(id);
+   double x, y;
+
+   if(inst == NULL)
+      return;
+
+   x = svg_x(inst->col);
+   y = svg_y(svg.level);
+   buf_line(&svg.front, x, y, x + 0.6 * svg.inst_dist, y, "stroke=\"black\" marker-end=\"url(#arrow)\"");
+   buf_printf(&svg.front, "<circle cx=\"%.1f\" cy=\"%.1f\" r=\"1\"/>\n", x + 0.6 * svg.inst_dist + 1, y);
+   buf_label(&svg.front, x + 0.3 * svg.inst_dist, y - 1, "middle", text);
+}
+
+void svg_found(const char * text, const void * id)
+{
+   struct svg_inst * inst = svg_find(id);
+   double x, y;
+
+   if(inst == NULL)
+      return;
+
+   x = svg_x(inst->col);
+   y = svg_y(svg.level);
+   buf_printf(&svg.front, "<circle cx=\"%.1f\" cy=\"%.1f\" r=\"1\" fill=\"white\" stroke=\"black\"/>\n", x + 0.6 * svg.inst_dist + 1, y);
+   buf_line(&svg.front, x + 0.6 * svg.inst_dist, y, x, y, "stroke=\"black\" marker-end=\"url(#arrow)\"");
+   buf_label(&svg.front, x + 0.3 * svg.inst_dist, y - 1, "middle", text);
+}
+
+void svg_order(const void * from, const void * to)
+{
+   struct svg_inst * a = svg_find(from);
+   struct svg_inst * b = svg_find(to);
+   double y = svg_y(svg.level);
+
+   if((a == NULL) || (b == NULL) || (a == b))
+      return;
+
+   buf_line(&svg.front, svg_x(a->col), y, svg_x(b->col), y,
+            "stroke=\"black\" stroke-dasharray=\"0.5,1\" marker-end=\"url(#arrow)\"");
+}
+
+/**
+ * box centered on an instance, at the current level
+ */
+static void svg_box(const char * text, const void * id, int condition)
+{
+   struct svg_inst * inst = svg_find(id);
+   double x, y, w, h;
+
+   if(inst == NULL)
+      return;
+
+   x = svg_x(inst->col);
+   y = svg_y(svg.level);
+   w = svg_head_width();
+   h = svg.box_height;
+
+   if(condition)
+   {
+      buf_printf(&svg.front, "<path d=\"M%.1f,%.1f L%.1f,%.1f H%.1f L%.1f,%.1f L%.1f,%.1f H%.1f z\" fill=\"white\" stroke=\"black\"/>\n",
+                 x - w / 2 - 2, y, x - w / 2, y - h / 2, x + w / 2, x + w / 2 + 2, y, x + w / 2, y + h / 2, x - w / 2);
+   }
+   else
+   {
+      buf_printf(&svg.front, "<rect x=\"%.1f\" y=\"%.1f\" width=\"%.1f\" height=\"%.1f\" fill=\"white\" stroke=\"black\"/>\n",
+                 x - w / 2, y - h / 2, w, h);
+   }
+   buf_label(&svg.front, x, y + 1, "middle", text);
+}
+
+void svg_action(const char * text, const void * id)
+{
+   svg_box(text, id, 0);
+}
+
+void svg_condition(const char * text, const void * id)
+{
+   svg_box(text, id, 1);
+}
+
+void svg_comment(const char * text, const void * id)
+{
+   struct svg_inst * inst = svg_find(id);
+   double x, y, d;
+
+   if(inst == NULL)
+      return;
+
+   x = svg_x(inst->col);
+   y = svg_y(svg.level);
+   d = svg.inst_dist / 2;
+   buf_line(&svg.front, x, y, x + d, y, "stroke=\"black\" stroke-dasharray=\"1,1\"");
+   buf_printf(&svg.front, "<path d=\"M%.1f,%.1f h-1 V%.1f h1\" fill=\"none\" stroke=\"black\"/>\n",
+              x + d + 1, y - 2, y + 2);
+   buf_label(&svg.front, x + d + 1.5, y + 1, "start", text);
+}
+
+void svg_timer(int kind, const char * text, const void * id, int off)
+{
+   struct svg_inst * inst = svg_find(id);
+   double x, xs, y, y2;
+
+   if(inst == NULL)
+      return;
+
+   x  = svg_x(inst->col);
+   xs = x + svg.inst_dist / 4;
+   y  = svg_y(svg.level);
+   y2 = svg_y(svg.level + off);
+
+   switch(kind)
+   {
+      case SVG_TIMER_SET:
+         buf_line(&svg.front, x, y, xs - SVG_SYMBOL, y, "stroke=\"black\"");
+         svg_hourglass(&svg.front, xs, y);
+         break;
+      case SVG_TIMER_TIMEOUT:
+         svg_hourglass(&svg.front, xs, y);
+         buf_line(&svg.front, xs - SVG_SYMBOL, y, x, y, "stroke=\"black\" marker-end=\"url(#arrow)\"");
+         break;
+      case SVG_TIMER_STOP:
+         buf_line(&svg.front, x, y, xs, y, "stroke=\"black\"");
+         svg_cross(&svg.front, xs, y);
+         break;
+      case SVG_TIMER_SET_TIMEOUT:
+      case SVG_TIMER_SET_STOP:
+         svg_reach(svg.level + off);
+         buf_line(&svg.front, x, y, xs - SVG_SYMBOL, y, "stroke=\"black\"");
+         svg_hourglass(&svg.front, xs, y);
+         buf_line(&svg.front, xs, y + SVG_SYMBOL, xs, y2, "stroke=\"black\"");
+         if(kind == SVG_TIMER_SET_STOP)
+         {
+            buf_line(&svg.front, xs, y2, x, y2, "stroke=\"black\"");
+            svg_cross(&svg.front, xs, y2);
+         }
+         else
+         {
+            buf_line(&svg.front, xs, y2, x, y2, "stroke=\"black\" marker-end=\"url(#arrow)\"");
+         }
+         break;
+   }
+   buf_label(&svg.front, xs + SVG_SYMBOL + 1, y + 1, "start", text);
+}
@@ -0,0 +1,160 @@
+#ifndef MSC_SVG_H
+#define MSC_SVG_H
+
+#include <lib.h>
+
+/**
+ * \addtogroup RTSV
+ * @{
+ * \addtogroup svg
+ * Native rendering of msc pages in svg files. Each function draws the msc.sty command of the same name, at the
+ * current level of the page, so that the svg pages look like the pages compiled from the latex document.
+ * Instances are identified by an opaque pointer, like the %x names of the latex document.
+ * All functions do nothing until @ref svg_open has been called.
+ * @{
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * kinds of regions along an instance
+ */
+enum svg_region
+{
+   SVG_REGION_ACTIVATION = 0,
+   SVG_REGION_COREGION   = 1,
+   SVG_REGION_SUSPENSION = 2,
+};
+
+/**
+ * timer symbols
+ */
+enum svg_timer
+{
+   SVG_TIMER_SET         = 0,   /// \\settimer
+   SVG_TIMER_TIMEOUT     = 1,   /// \\timeout
+   SVG_TIMER_STOP        = 2,   /// \\stoptimer
+   SVG_TIMER_SET_TIMEOUT = 3,   /// \\settimeout, set then expired off levels later
+   SVG_TIMER_SET_STOP    = 4,   /// \\setstoptimer, set then stopped off levels later
+};
+
+/**
+ * Start rendering pages in a directory, with the geometry of the latex document
+ * @param[in] dir          directory of the svg pages, created if needed
+ * @param[in] level_height height of a level, in mm
+ * @param[in] box_height   height of instance heads, actions and conditions, in mm
+ * @param[in] inst_dist    distance between instances, in mm
+ * @return 0 (OK) or -1
+ */
+int  svg_open(const char * dir, int level_height, int box_height, int inst_dist);
+
+/**
+ * Stop rendering. A page that is still open is written.
+ */
+void svg_close(void);
+
+/**
+ * @return 1 if pages are rendered, 0 otherwise
+ */
+int  svg_enabled(void);
+
+/**
+ * \\begin{msc}: start a new page, without instances
+ */
+void svg_page_start(const char * title);
+
+/**
+ * \\end{msc}: terminate instances and regions, then write the page in page_<n>.svg
+ */
+void svg_page_end(void);
+
+/**
+ * \\nextlevel[n]
+ */
+void svg_nextlevel(int n);
+
+/**
+ * \\mscmark: text at the left of the current level, above it (top) or below it
+ */
+void svg_mark(int top, const char * text);
+
+/**
+ * \\declinst: instance starting at the top of the page
+ */
+void svg_declinst(const void * id, const char * above, const char * name);
+
+/**
+ * \\dummyinst: column of an instance created later
+ */
+void svg_dummyinst(const void * id);
+
+/**
+ * \\create: instance created at the current level by another one
+ */
+void svg_create(const char * label, const void * creator, const void * id, const char * above, const char * name);
+
+/**
+ * \\stop: end of an instance at the current level
+ */
+void svg_stop(const void * id);
+
+/**
+ * \\mess: message from an instance to another one, received off levels later. Dashed messages are \\mess*
+ */
+void svg_mess(const char * text, const void * from, const void * to, int off, int dashed);
+
+/**
+ * \\lost[r]: message sent to the right, never received
+ */
+void svg_lost(const char * text, const void * id);
+
+/**
+ * \\found[r]: message received from the right, never sent
+ */
+void svg_found(const char * text, const void * id);
+
+/**
+ * \\order: general ordering between two instances
+ */
+void svg_order(const void * from, const void * to);
+
+/**
+ * \\regionstart: start a region of an instance, ending the current one if any
+ */
+void svg_region_start(const void * id, int kind);
+
+/**
+ * \\regionend
+ */
+void svg_region_end(const void * id);
+
+/**
+ * \\action*
+ */
+void svg_action(const char * text, const void * id);
+
+/**
+ * \\condition*
+ */
+void svg_condition(const char * text, const void * id);
+
+/**
+ * \\msccomment[r]
+ */
+void svg_comment(const char * text, const void * id);
+
+/**
+ * timer symbols (enum svg_timer). off is the number of levels between setting and expiry or stop
+ */
+void svg_timer(int kind, const char * text, const void * id, int off);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@} svg
+ * @} RTSV */
+
+#endif
@@ -1,4 +1,4 @@
-
+#define _GNU_SOURCE
 
 #include "rtsv.h"
 
@@ -12,7 +12,14 @@
 
 #include <lib_set_logs.h>
 
-#include <sys/select.h>
+#include <sys/epoll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <sys/wait.h>
+#include <spawn.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -33,10 +40,11 @@ enum rt_class
 };
 
 struct rt_object;
+struct rt_event;
 
 
 /**
- * Each command received from network is extracted into a structure like this one.
+ * Each command is expanded into a structure like this one, when it is processed.
  *
  */
 struct rt_msg
@@ -56,13 +64,95 @@ struct rt_msg
     object_id_t        id1;
     object_id_t        id2;
     rt_time_t          time;       /// original timestamp from the sender
-    char               text[RT_CFG_MAX_TEXT_LEN];
+    char             * text;       /// text of the message, "" if none. It must not be modified
+    struct rt_text   * txt;        /// interned text of the message, NULL if none
+
+    // correlated message if any, for msc messages only
+    int                corr;       /// 1 if the message is correlated
+    rt_cmd_t           corr_cmd;   /// command of the correlated message
+    struct rt_event  * corr_event; /// correlated message, as long as it is queued
+    int                aggr;       /// 1 if the message is aggregated with a previous one, and not drawn
+};
+
+/**
+ * Text shared by all messages and objects carrying it: message texts, object names and keys, and the values of
+ * string objects. A text is freed when its last message is processed and its last object is deleted.
+ */
+struct rt_text
+{
+   hash_node_t        node;       /// entry in rt_text_index
+   int                ref;        /// number of messages and objects carrying this text
+   struct rt_text   * key;        /// same text without separators, NULL until needed. A key is its own key
+   char               str[];
+};
+
+/**
+ * Return the string of a text, "" for no text
+ */
+static inline char * text_str(struct rt_text * t)
+{
+   return t ? t->str : (char *)"";
+}
+
+/**
+ * Take one more reference on a text
+ */
+static inline struct rt_text * text_hold(struct rt_text * t)
+{
+   if(t)
+      t->ref++;
+   return t;
+}
+
+struct rt_text * text_get(const char * str);
+
+struct rt_text * text_key(struct rt_text * t);
+
+void text_put(struct rt_text * t);
+
+/**
+ * Compact form of a command, while it waits in the rt_queue.
+ */
+struct rt_event
+{
+   rt_time_t          time;       /// original timestamp from the sender
+   uint32_t           seq;        /// arrival order, to sort queued messages having the same time
+   object_id_t        gid;
+   object_id_t        id1;
+   object_id_t        id2;
+   struct rt_text   * text;       /// NULL if the message has no text
+   rt_time_t          off;        /// time for asynchronous reception, if correlated
+   uint16_t           fid;        /// file descriptor of the source
+   uint8_t            cmd;
+   uint8_t            flags;      /// RT_EVENT_xxx
+   struct rt_corr   * corr;       /// entry of the correlation index, NULL if none
+};
 
-    // correlated message if any
-    struct rt_msg    * corr;       /// for msc messages only
-    list_node_t        node;       /// messages are queued from older one to more recent one in a queue.
+/**
+ * Queued receptions of the same (identifier, identifier, text), in rt_queue order. Identifiers are those of the
+ * messages: the instances they name are only known when the sent message is processed.
+ */
+struct rt_corr
+{
+   hash_node_t        node;       /// entry in rt_corr_index
+   object_id_t        id1;        /// identifiers of the messages
+   object_id_t        id2;
+   struct rt_text   * text;       /// text of the messages, NULL if none
+   int                count;      /// number of queued messages
+   int                max;        /// size of the queued array
+   struct rt_event ** queued;     /// queued messages, in rt_queue order
 };
 
+/**
+ * the queued message is correlated with a processed one
+ */
+#define RT_EVENT_CORR 1
+
+/**
+ * the queued message is correlated with an aggregated one, and is not drawn
+ */
+#define RT_EVENT_AGGR 2
+
 /**
  * object type
  */
@@ -127,7 +217,7 @@ msc_mark_display_t;
 int rt_log_level = DEBUG_ERROR;
 
 /**
- * Variant type to store the value of an object. Some values are dynamic pointeur to strings
+ * Variant type to store the value of an object. Values of RT_STRING, RT_TASK and RT_OBJECT are interned texts
  */
 typedef size_t object_value_t;
 
@@ -146,14 +236,19 @@ struct rt_object
    object_value_t     value;                     /// the value of a object, must be kept between page breaks
    object_status_t    status;                    /// object status, for RT_TASK and RT_OBJECT
    int                quantification;            /// size of the object in bits, for fixed size objects
-   char               name[RT_CFG_MAX_TEXT_LEN]; /// object name
-   char               key[RT_CFG_MAX_TEXT_LEN];  /// object name without any space
+   struct rt_text   * name;                      /// object name
+   struct rt_text   * key;                       /// object name without any space, held by the name
    struct rt_object * group;                     /// parent group, if any. NULL means at the 'top'
    list_node_t        node;                      /// objects are queued in the order they werre created. 
    list_node_t        list;                      /// if object is a group, this is a list of sub groups or objects
    int                zombie;                    /// deleted objects become zombie before being removed.
    int                global;                    /// 1 if this object as a global scope.
    object_id_t        global_id;                 /// global object identifier, at system level, independantly of the fid
+   hash_node_t        local_node;                /// entry in the (fid, oid) index, while the object is alive
+   hash_node_t        global_node;               /// entry in the global_id index, while the object is alive and global
+   uint32_t           uid;                       /// msc instance name, in creation order, stable from one run to another
+   int                msc_seg;                   /// with a page buffer, segment drawing the instance at the start of a page
+   uint32_t           msc_seg_page;              /// page of msc_seg
 };
 
 /**
@@ -166,6 +261,13 @@ int for_each_object(struct rt_object * obj, iterate_object_t action, void * info
 
 void exec_cmd(struct rt_msg * m);
 
+int  untimed_levels(struct rt_event * k);
+
+int  classify_cmd(rt_cmd_t cmd);
+
+void rt_view_insert(struct rt_object * k, int msc_only);
+void rt_view_remove(struct rt_object * k, int msc_only);
+
 /**
  * global file descriptors
  */
@@ -178,6 +280,14 @@ int sdl_fd = -1;
  */
 int vcd_def_fd = -1;
 
+/**
+ * return 1 if msc pages are written, in a latex document or in svg files
+ */
+static inline int msc_output()
+{
+   return (msc_fd > 0) || svg_enabled();
+}
+
 /**
  * global outputs enable
  */
@@ -192,15 +302,266 @@ int vcd_def_out = 0;
 int vcd_def_end = 0;
 
 /**
- * List of rt_msg queued before beeing processed
+ * Algorithms available to reorder messages before processing them
+ */
+typedef enum rt_queue_algo
+{
+   RT_QUEUE_LIST = 0,   /// sorted array, insertion from the newest message
+   RT_QUEUE_HEAP = 1,   /// binary heap, O(log n) insertion whatever the arrival order
+}
+rt_queue_algo_t;
+
+/**
+ * Reorder algorithm in use.
+ */
+rt_queue_algo_t rt_queue_algo = RT_QUEUE_HEAP;
+
+/**
+ * Sorted array of messages queued before beeing processed (RT_QUEUE_LIST). Queued messages are
+ * rt_list[rt_list_head] to rt_list[rt_list_head + rt_list_count - 1].
+ */
+struct rt_event ** rt_list = NULL;
+int                rt_list_head = 0;
+int                rt_list_count = 0;
+int                rt_list_max = 0;
+
+/**
+ * Binary heap of messages queued before beeing processed (RT_QUEUE_HEAP)
+ */
+struct rt_event ** rt_heap = NULL;
+int              rt_heap_count = 0;
+int              rt_heap_max = 0;
+
+/**
+ * time of the newest queued message
+ */
+rt_time_t rt_queue_newest = 0;
+
+/**
+ * Untimed levels and time of the last processed message. They are carried from one flush to the next,
+ * so that untimed levels are computed once for each message, when it leaves the queue.
+ */
+int       untimed_started   = 0;
+rt_time_t untimed_time      = 0;
+int       untimed_msc_level = 0;
+int       untimed_vcd_level = 0;
+
+/**
+ * Distinct times of the queued messages, kept in ascending order when msc_untimed is set. The msc level of a
+ * queued message only depends on the times queued before it whose first message is drawn in the msc, so each
+ * slot keeps their running count: a correlated reception gets its level without walking the queue.
+ */
+struct rt_slot
+{
+   rt_time_t          time;
+   int                count;      /// number of queued messages of this time
+   int                msc;        /// 1 if the first message of this time is drawn in the msc
+   int                rank;       /// number of msc slots up to this one, from the first slot ever queued
+   struct rt_event  * first;      /// first message of this time in queue order, NULL once one is released
+};
+
+struct rt_slot * untimed_slots       = NULL;
+int              untimed_slots_head  = 0;
+int              untimed_slots_count = 0;
+int              untimed_slots_max   = 0;
+
+/**
+ * Each input file is a source of messages, supposed to be sorted by time.
+ */
+struct rt_source
+{
+   int                fd;         /// file descriptor, also used as message fid
+   int                eof;        /// 1 when the end of the file has been reached
+   rt_time_t          watermark;  /// time of the newest message read from this source
+   int                rank;       /// position in rt_source_heap, -1 if the source is not live
+   int                count;      /// number of messages read in the current lateness period
+   rt_time_t          late_max;   /// maximum lateness of a message in the current period
+   rt_time_t          late_prev;  /// maximum lateness of a message in the previous period
+
+   /* reader */
+   char             * data;       /// mapped file, or read buffer
+   size_t             size;       /// size of the mapping or of the read buffer
+   size_t             pos;        /// start of the next record in data
+   size_t             len;        /// end of the valid data in data
+   int                mapped;     /// 1 if data is the mapping of a regular file
+   int                binary;     /// 1 if records are binary blocks, 0 for text lines
+   int                end;        /// 1 when the end of the input is in data
+   char             * last;       /// copy of the unterminated last line of a mapped file
+   int                polled;     /// 1 if the input is watched by rt_epoll_fd
+   int                ready;      /// 1 if rt_epoll_fd reported data to read
+
+   /* decode worker */
+   int                threaded;   /// 1 if records are decoded by a worker, in ring
+   ring_t             ring;       /// records decoded by the worker (struct rt_record)
+   struct rt_worker * worker;     /// worker decoding the input, if threaded
+};
+
+/**
+ * A record of an input, decoded
+ */
+struct rt_record
+{
+   int                status;     /// RT_RECORD_xxx
+   rt_cmd_t           cmd;
+   rt_time_t          time;
+   object_id_t        gid;
+   object_id_t        id1;
+   object_id_t        id2;
+   char               text[RT_CFG_MAX_COMMAND_LEN]; /// text of the command, or the rejected line
+};
+
+enum rt_record_status
+{
+   RT_RECORD_CMD     = 0,   /// valid command
+   RT_RECORD_SKIP    = 1,   /// comment or empty line
+   RT_RECORD_BAD     = 2,   /// invalid text command
+   RT_RECORD_BAD_BIN = 3,   /// invalid binary command
+   RT_RECORD_END     = 4,   /// end of the input
+};
+
+/**
+ * number of decoded records buffered for each input decoded by a worker
+ */
+#define RT_RING_SIZE 256
+
+/**
+ * decode worker, and the inputs it decodes
+ */
+struct rt_worker
+{
+   pthread_t            thread;
+   struct rt_source  ** sources;
+   int                  count;
+   int                  stop;       /// 1 if the worker must end before its inputs
+   int                  sleeping;   /// 1 if the worker waits on room for records in its rings
+   int                  waited;     /// 1 if the main thread waits on records from one of its rings
+   pthread_mutex_t      lock;
+   pthread_cond_t       room;       /// signaled by the main thread when a full ring is half consumed
+   pthread_cond_t       records;    /// signaled by the worker when it has committed records
+};
+
+/**
+ * number of decode workers (0: inputs are decoded by the main thread)
+ */
+int                 rt_threads = 0;
+struct rt_worker  * rt_workers = NULL;
+
+/**
+ * size of the read buffer of inputs that cannot be mapped
+ */
+#define RT_READ_BUF_SIZE (64 * 1024)
+
+/**
+ * Open inputs, sorted by file descriptor. They are read in turn, rt_input_batch records at a time.
+ */
+struct rt_source ** rt_inputs = NULL;
+int                 rt_input_count = 0;
+int                 rt_inputs_max = 0;
+int                 rt_input_batch = 1;
+
+/**
+ * epoll instance watching inputs read by blocks (pipes, terminals). Regular files are always ready.
+ */
+int rt_epoll_fd = -1;
+int rt_epoll_count = 0;
+
+/**
+ * sources, indexed by their file descriptor
+ */
+struct rt_source ** rt_sources = NULL;
+int                 rt_sources_max = 0;
+
+/**
+ * live sources, sorted by watermark in a binary heap. The first one gives the low watermark.
+ */
+struct rt_source ** rt_source_heap = NULL;
+int                 rt_source_count = 0;
+
+/**
+ * When the adaptive window is enabled, rt_queue_flush follows the lateness of messages, that is the distance between
+ * the newest queued message and a message when it is queued. The window is widened as soon as a message is later than
+ * expected, and narrowed when the lateness decreases for RT_QUEUE_ADAPT_PERIOD messages of each source.
+ */
+#define RT_QUEUE_ADAPT_PERIOD 4096
+int       rt_queue_adapt = 0;
+rt_time_t rt_queue_min = 1;
+rt_time_t rt_queue_max = 1000000;
+
+/**
+ * statistics of the reorder window
+ */
+int       rt_queue_widened = 0;     /// number of times the adaptive window was widened
+int       rt_queue_late = 0;        /// number of messages queued after more recent ones were processed
+rt_time_t rt_queue_late_max = 0;    /// maximum lateness of a message
+rt_time_t rt_queue_last = 0;        /// time of the last processed message
+
+/**
+ * When merge mode is enabled, a message is processed as soon as all live sources have read a more recent
+ * message (from rt_queue_flush distance), instead of waiting for the newest queued message.
+ */
+int rt_merge = 0;
+
+/**
+ * Index of texts carried by messages
+ */
+hash_table_t rt_text_index;
+
+/**
+ * Correlation index of queued receptions
+ */
+hash_table_t rt_corr_index;
+
+/**
+ * arrival counter of messages in the rt_queue
+ */
+uint32_t rt_queue_seq = 0;
+
+/**
+ * Pools of queued messages and of objects
+ */
+heap_pool_t * rt_event_pool;
+heap_pool_t * rt_object_pool;
+
+/**
+ * print pool statistics at exit
  */
-list_node_t rt_queue;
+int rt_stats = 0;
 
 /**
  * List of created objects, that we must recreate after each page break
  */
 struct rt_object top;
 
+/**
+ * next msc instance name. Names are not pointers, so that msc pages of a trace are identical from one run to another
+ */
+uint32_t rt_object_uid = 0;
+
+/**
+ * 1 when the flat views of the object tree could not follow its changes, and must be rebuilt
+ */
+int rt_view_dirty = 0;
+
+/**
+ * Index of all living objects by (fid, oid), and of living global objects by global_id.
+ * Zombies are never indexed. This avoids to walk the whole group tree on each object reference.
+ */
+hash_table_t rt_local_index;
+hash_table_t rt_global_index;
+
+/**
+ * Index of zombies by (fid, type, group, name), to reuse them without walking the group tree.
+ * A zombie is indexed through its local_node, which a dead object does not use anymore.
+ */
+hash_table_t rt_zombie_index;
+
+/**
+ * Zombies that nothing can reference anymore are compacted: they leave the group tree and the zombie index,
+ * and their memory waits here until no svg page uses their address as an instance id.
+ */
+list_node_t rt_graveyard;
+int         rt_graveyard_count = 0;
+
 /**
  * Frequency at which the rt_time is working
  */
@@ -221,6 +582,29 @@ rt_time_t msc_level = 0;
  */
 rt_time_t msc_page = 0;
 
+/**
+ * in timed mode, idle spans longer than msc_gap ticks are collapsed into one level. 0 keeps all levels
+ */
+int       msc_gap = 0;
+
+/**
+ * number of ticks removed by collapsed spans, and number of collapsed spans
+ */
+rt_time_t msc_gap_shift = 0;
+int       msc_gap_count = 0;
+
+/**
+ * identical msc events repeated within msc_aggregate ticks are drawn once, then annotated with their count.
+ * 0 draws all events
+ */
+int       msc_aggregate = 0;
+
+/**
+ * levels removed by aggregated events, and number of aggregated events
+ */
+rt_time_t msc_aggr_shift = 0;
+int       msc_aggr_count = 0;
+
 /**
  * maximum level we can exhib one one page
  */
@@ -251,6 +635,55 @@ int msc_page_instances = 0;
  */
 int msc_max_instances = 0;
 
+/**
+ * 1 if msc pages only show the instances they use
+ */
+int msc_cull = 0;
+
+/**
+ * maximum number of instances per msc sheet. Pages showing more instances are split in several sheets.
+ * 0 keeps all instances of a page on one sheet
+ */
+int msc_page_max_instances = 0;
+
+/**
+ * 1 if msc pages are written in a page buffer before the document (-msc_cull or -msc_page_max_instances)
+ */
+int msc_buffered = 0;
+
+/**
+ * number of worker processes compiling msc units while the simulation goes on. With 0, the whole msc document
+ * is compiled at the end
+ */
+int msc_jobs = 0;
+
+/**
+ * number of msc pages per unit, with -msc_jobs
+ */
+int msc_batch = 1;
+
+/**
+ * msc document name, without extension. Units are named <msc_base>_<unit>.tex
+ */
+char msc_base[RT_CFG_MAX_TEXT_LEN] = "";
+
+/**
+ * current msc unit, the number of pages terminated in it and its maximum number of instances per page
+ */
+int msc_unit = 0;
+int msc_unit_pages = 0;
+int msc_unit_instances = 0;
+
+/**
+ * directory of compiled msc units, named by the hash of their latex text. Empty when there is no cache
+ */
+char msc_cache[RT_CFG_MAX_TEXT_LEN] = "";
+
+/**
+ * number of msc units found in the cache
+ */
+int msc_cache_hits = 0;
+
 /**
  * msc mark granularity
  */
@@ -285,6 +718,12 @@ rt_time_t vcd_untimed = 0;
  */
 int vcd_fifo = 0;
 
+/**
+ * Space reserved for definitions at the beginning of the vcd file, when not in fifo mode. Value changes are written after it,
+ * and definitions are copied in it at exit.
+ */
+int vcd_header = 65536;
+
 /**
  * Return a string for object type
  */
@@ -366,9 +805,9 @@ void generate_key(char * key, const char * text)
 rt_time_t msc_get_time(struct rt_msg * m)
 {
    if(msc_untimed)
-      return m->msc_level;
+      return m->msc_level - msc_aggr_shift;
    else
-      return m->time;
+      return m->time - msc_gap_shift - msc_aggr_shift;
 }
 
 /**
@@ -383,112 +822,84 @@ rt_time_t vcd_get_time(struct rt_msg * m)
 }
 
 /**
- * Internal structure for find_object method
+ * hash keys of the object indexes
  */
-struct find_info
+static inline uint32_t local_object_hash(int fid, object_id_t oid)
 {
-   int                fid;        // file id to find, if not -1
-   object_id_t        oid;        // object id to find
-   struct rt_object * group;      // matching group
-   const char       * name;
-   object_type_t      type;
-   int                global;     // find also among global objects
-   struct rt_object * found_obj;  // the object found, it exists
-};
+   return hash_combine(hash_u64(oid), (uint32_t)fid);
+}
+
+static inline uint32_t global_object_hash(object_id_t global_id)
+{
+   return hash_u64(global_id);
+}
+
+static inline uint32_t zombie_object_hash(int fid, object_type_t type, struct rt_object * group, const char * name)
+{
+   return hash_combine(hash_combine(hash_string(name), (uint32_t)fid), hash_combine(hash_u64((uintptr_t)group), type));
+}
 
 /**
- * An iterator function for the find_object method
+ * zombies of the same key are kept in creation order, like in their group list
  */
-static int find_local_object_iterator(struct rt_object *k, int exit, void * data)
+static int zombie_before(hash_node_t * a, hash_node_t * b)
 {
-   struct find_info * inf = ((struct find_info *)data);
-
-   if((!k->zombie)                                          // find among existing objects
-   && ((k->oid == inf->oid) && (k->fid == inf->fid)))       // source processor file matching is optional
-   {
-      inf->found_obj = k;
-      return 1;
-   }
-   else
-   {
-      return 0;
-   }
+   return hash_entry(a, struct rt_object, local_node)->uid < hash_entry(b, struct rt_object, local_node)->uid;
 }
 
 /**
- * An iterator function for the find_object method
+ * find an oid among local objects.
  */
-static int find_global_object_iterator(struct rt_object *k, int exit, void * data)
+struct rt_object * find_local_object(int fid, object_id_t oid)
 {
-   struct find_info * inf = ((struct find_info *)data);
+   hash_node_t * pos;
+   uint32_t h = local_object_hash(fid, oid);
 
-   if((!k->zombie)                                           // find among existing objects
-   && ((k->global) && (k->global_id == inf->oid)))           // source processor file matching is optional
-   {
-      inf->found_obj = k;
-      return 1;
-   }
-   else
+   hash_for_each(pos, &rt_local_index, h)
    {
-      return 0;
+      struct rt_object * k = hash_entry(pos, struct rt_object, local_node);
+      if((k->oid == oid) && (k->fid == fid))
+         return k;
    }
+   return NULL;
 }
 
-
 /**
- * An iterator function for a reusable object with the same name, group, fid, quantif and type
+ * find an oid among global objects.
+ * If several objects share the same global identifier, the first one made global is returned.
  */
-static int find_reusable_object_iterator(struct rt_object *k, int exit, void * data)
+struct rt_object * find_global_object(object_id_t oid)
 {
-   struct find_info * inf = ((struct find_info *)data);
+   hash_node_t * pos;
+   uint32_t h = global_object_hash(oid);
 
-    if((k->zombie)
-    &&((inf->fid == -1) || (k->fid == inf->fid))      // source processor file matching is optional
-    && (inf->type == k->type) 
-    && (inf->group == k->group) 
-    && (string_cmp(inf->name, k->name) == 0))
-   {
-      inf->found_obj = k;
-      return 1;
-   }
-   else
+   hash_for_each(pos, &rt_global_index, h)
    {
-      return 0;
+      struct rt_object * k = hash_entry(pos, struct rt_object, global_node);
+      if(k->global_id == oid)
+         return k;
    }
+   return NULL;
 }
 
-
 /**
- * find an oid among local objects.
+ * give a global scope to an object
  */
-struct rt_object * find_local_object(int fid, object_id_t oid)
+void set_object_global(struct rt_object * obj, object_id_t global_id)
 {
-   struct find_info inf;
-
-   inf.fid       = fid;
-   inf.oid       = oid;
-   inf.found_obj = NULL;
-
-   // VERB("find obj %x zombie=%d\n", oid, zombies);
-   for_each_object(&top, find_local_object_iterator, &inf);
-
-   return inf.found_obj;
+   hash_delete(&rt_global_index, &obj->global_node);
+   obj->global    = 1;
+   obj->global_id = global_id;
+   hash_insert(&rt_global_index, &obj->global_node, global_object_hash(global_id));
 }
 
 /**
- * find an oid among global objects.
+ * remove an object from the indexes. It cannot be found anymore by find_object, or reused if it is a zombie
  */
-struct rt_object * find_global_object(object_id_t oid)
+void unindex_object(struct rt_object * obj)
 {
-   struct find_info inf;
-
-   inf.oid       = oid;
-   inf.found_obj = NULL;
-
-   // VERB("find obj %x zombie=%d\n", oid, zombies);
-   for_each_object(&top, find_global_object_iterator, &inf);
-
-   return inf.found_obj;
+   hash_delete(obj->zombie ? &rt_zombie_index : &rt_local_index, &obj->local_node);
+   hash_delete(&rt_global_index, &obj->global_node);
 }
 
 /**
@@ -510,18 +921,16 @@ struct rt_object * find_object(int fid, object_id_t oid)
  */
 struct rt_object * find_reusable_object(int fid, object_id_t oid, const char * name, object_type_t type, struct rt_object * group)
 {
-   struct find_info inf;
+   hash_node_t * pos;
+   uint32_t h = zombie_object_hash(fid, type, group, name);
 
-   inf.fid       = fid;
-   inf.name      = name;
-   inf.type      = type;
-   inf.group     = group;
-   inf.found_obj = NULL;
-
-   // VERB("find obj %x zombie=%d\n", oid, zombies);
-   for_each_object(&top, find_reusable_object_iterator, &inf);
-
-   return inf.found_obj;
+   hash_for_each(pos, &rt_zombie_index, h)
+   {
+      struct rt_object * k = hash_entry(pos, struct rt_object, local_node);
+      if((k->fid == fid) && (k->type == type) && (k->group == group) && (string_cmp(text_str(k->name), name) == 0))
+         return k;
+   }
+   return NULL;
 }
 
 
@@ -552,14 +961,20 @@ void init_object(struct rt_object * obj, const char * name, int fid, object_id_t
    obj->global     = 0;
    obj->global_id  = 0;
 
+   // a new object is alive, so it is indexed by (fid, oid) only
+   hash_node_init(&obj->global_node);
+   hash_insert(&rt_local_index, &obj->local_node, local_object_hash(light ? obj->fid : fid, oid));
+
    if(light == 0)
    {
+      obj->uid   = rt_object_uid++;
+      obj->msc_seg_page = 0;
       obj->fid   = fid;
       obj->type  = type;
       obj->group = group;
 
-      string_cpy(obj->name, name);
-      generate_key(obj->key, name);
+      obj->name = text_get(name);
+      obj->key  = text_key(obj->name);
 
       list_init(&obj->list);
 
@@ -569,16 +984,18 @@ void init_object(struct rt_object * obj, const char * name, int fid, object_id_t
          list_add_tail(&obj->node, &group->list);
    }
 
+   // a reused zombie is still in the vcd view
+   rt_view_insert(obj, light);
+
    switch(obj->type)
    {
       case RT_OBJECT:
       case RT_TASK:
       case RT_STRING:
-         if(light == 0)
-            obj->value = (size_t)heap_alloc(RT_CFG_MAX_TEXT_LEN);
-
-         if(obj->value)
-            string_cpy((char *)obj->value, "UNDEF");
+         // a reused zombie releases its last value
+         if(light)
+            text_put((struct rt_text *)obj->value);
+         obj->value = (object_value_t)text_get("UNDEF");
          break;
       case RT_REAL:
       case RT_PARAM:
@@ -599,19 +1016,21 @@ void init_object(struct rt_object * obj, const char * name, int fid, object_id_t
 /**
  * reset object:
  * Remove the object from the parent list
- * Also remove dynamically allocated memory for RT_STRING, RT_TASK and RT_OBJECT
+ * Also release the name of the object, and the value of RT_STRING, RT_TASK and RT_OBJECT
  */
 void reset_object(struct rt_object * obj)
 {
    // remove the object from the group list or from the top list
    list_delete(&obj->node);
+   unindex_object(obj);
+   rt_view_remove(obj, 0);
+   text_put(obj->name);
    switch(obj->type)
    {
       case RT_OBJECT:
       case RT_TASK:
       case RT_STRING:
-         if(obj->value)
-            heap_free((void *)obj->value);
+         text_put((struct rt_text *)obj->value);
          break;
       default:
          break;
@@ -640,18 +1059,19 @@ struct rt_object * add_object(int fid, object_id_t oid, object_type_t type, stru
       if(obj)
       {
          VERB("reuse zombie object '%s' with identifier fid=%x oid %x\n", name, obj->fid, obj->oid);
+         unindex_object(obj);
          light = 1;
       }
       else
       {
-         obj = (struct rt_object *)heap_alloc(sizeof(struct rt_object));
+         obj = (struct rt_object *)heap_pool_alloc(rt_object_pool);
       }
    }
 
    if(obj)
    {
       init_object(obj, name, fid, oid, type, group, light);
-      VERB("add object '%s' fid=%x oid %x\n", obj->name, obj->fid, obj->oid);
+      VERB("add object '%s' fid=%x oid %x\n", text_str(obj->name), obj->fid, obj->oid);
    }
    else
    {
@@ -666,27 +1086,104 @@ struct rt_object * add_object(int fid, object_id_t oid, object_type_t type, stru
 void del_object(struct rt_object * obj)
 {
    reset_object(obj);
-   heap_free(obj);
+   heap_pool_free(rt_object_pool, obj);
 }
 
 /**
- * Remove one object from the list
- * return -1 if an error occured, 0 otherwise
+ * Release the memory of compacted zombies, once no svg page can reference them
  */
-int del_object_by_id(int fid, object_id_t oid, int zombie)
+void flush_graveyard(void)
 {
-   struct rt_object * obj;
-   obj = find_local_object(fid, oid);
-   if(obj == NULL)
+   list_node_t * node;
+   list_node_t * tmp;
+
+   list_for_each_safe(node, tmp, &rt_graveyard)
    {
-      ERROR("cannot del object with oid %x, not found\n", oid);
-      return -1;
+      list_delete(node);
+      heap_pool_free(rt_object_pool, list_entry(node, struct rt_object, node));
    }
+}
 
-   VERB("del object '%s' fid=%x oid %x (zombie <= %d)\n", obj->name, obj->fid, obj->oid, zombie);
-   if(zombie)
-      obj->zombie = 1;
-   else
+/**
+ * 1 if a zombie can be compacted: it has no child, and its vcd definition is never written again, because there
+ * is no vcd file or because the definitions of a vcd fifo are already written
+ */
+static inline int zombie_compactable(struct rt_object * obj)
+{
+   return obj->zombie && list_empty(&obj->list) && ((vcd_fd <= 0) || (vcd_fifo && vcd_def_end));
+}
+
+/**
+ * Compact a zombie: remove it from the group tree and from the zombie index, and release its texts
+ */
+void bury_object(struct rt_object * obj)
+{
+   reset_object(obj);
+   list_add_tail(&obj->node, &rt_graveyard);
+   rt_graveyard_count++;
+
+   // instance ids of svg pages are object addresses
+   if(!svg_enabled())
+      flush_graveyard();
+}
+
+/**
+ * An iterator function for compact_zombies function.
+ */
+static int compact_iterator(struct rt_object * k, int exit, void * info)
+{
+   if(exit && (k != &top) && zombie_compactable(k))
+      bury_object(k);
+
+   return 0;
+}
+
+/**
+ * Compact all zombies that can be, when vcd definitions are written
+ */
+void compact_zombies(void)
+{
+   for_each_object(&top, compact_iterator, NULL);
+}
+
+/**
+ * Remove one object from the list
+ * return -1 if an error occured, 0 otherwise
+ */
+int del_object_by_id(int fid, object_id_t oid, int zombie)
+{
+   struct rt_object * obj;
+   obj = find_local_object(fid, oid);
+   if(obj == NULL)
+   {
+      ERROR("cannot del object with oid %x, not found\n", oid);
+      return -1;
+   }
+
+   VERB("del object '%s' fid=%x oid %x (zombie <= %d)\n", text_str(obj->name), obj->fid, obj->oid, zombie);
+   if(zombie)
+   {
+      unindex_object(obj);
+      obj->zombie = 1;
+      rt_view_remove(obj, 1);
+
+      if(!zombie_compactable(obj))
+      {
+         hash_insert_sorted(&rt_zombie_index, &obj->local_node,
+                            zombie_object_hash(obj->fid, obj->type, obj->group, text_str(obj->name)), zombie_before);
+         return 0;
+      }
+
+      // a zombie group left empty is compacted after its last child
+      while(obj && (obj != &top) && zombie_compactable(obj))
+      {
+         struct rt_object * group = obj->group;
+
+         bury_object(obj);
+         obj = group;
+      }
+   }
+   else
       del_object(obj);
 
    return 0;
@@ -705,2521 +1202,6033 @@ static int remove_iterator(struct rt_object *k, int exit, void * data)
 
 
 /**
- * send one text line to a text file
+ * A block of output, given to a writer thread
  */
-int write_line(int fd, char * format, ...)
+struct rt_block
 {
-   va_list args;
-   char str[RT_CFG_MAX_COMMAND_LEN];
+   int                len;        /// number of bytes in data, or -1 to stop the writer
+   char               data[];
+};
 
-   if(fd < 0)
-      return -1;
+/**
+ * number of blocks buffered between the processing thread and a writer thread
+ */
+#define RT_SINK_SIZE 8
 
-   va_start (args, format);
-   string_vprintf(str, format, args);
-   va_end (args);
-   return write(fd, str, string_len(str));
-}
+/**
+ * number of times a writer polls its empty sink before sleeping
+ */
+#define RT_SINK_SPIN 100
 
 /**
- * init msc latex document
+ * Buffered output file. Lines are formatted in a block, which is written when it is full, on msc page breaks,
+ * before waiting for inputs, and when the file is closed.
+ * With -writers, full blocks are written by a writer thread.
  */
-int msc_new_doc(int fd)
+struct rt_sink
 {
-   write_line(fd, "\\documentclass{article}\n");
-   write_line(fd, "\\usepackage{msc}\n");
-   write_line(fd, "\\usepackage{geometry}\n");
-   write_line(fd, "\\geometry{paperwidth=PAPERWIDTHmm, paperheight=PAPERHEIGHTmm}\n");
-   write_line(fd, "\\geometry{top=1cm, bottom=1cm, left=1cm , right=1cm}\n");
-   write_line(fd, "\\begin{document}\n");
-   return 0;
-}
+   int                fd;
+   char             * buf;        /// block being filled
+   int                len;        /// number of bytes in buf
+   int                size;       /// size of buf
+
+   /* writer thread */
+   int                threaded;   /// 1 if blocks are written by thread
+   struct rt_block  * block;      /// block of ring being filled
+   ring_t             ring;       /// blocks to write (struct rt_block)
+   pthread_t          thread;
+   int                sleeping;   /// 1 if the writer waits for blocks on cond
+   pthread_mutex_t    lock;
+   pthread_cond_t     cond;
+};
 
 /**
- * init vcd document
+ * 1 if output files are written by writer threads
  */
-int vcd_new_doc(int fd, char * title)
+int                 rt_writers = 0;
+
+/**
+ * size of output buffers, in bytes
+ */
+int                 rt_out_buffer = 65536;
+
+/**
+ * buffered output files (msc, msc page, vcd values, vcd definitions, sdl)
+ */
+struct rt_sink    * rt_sinks[5];
+int                 rt_sink_count = 0;
+
+/**
+ * return the sink of an output file, or NULL if it is not buffered
+ */
+static inline struct rt_sink * sink_get(int fd)
 {
-   long int time_scale = 0;
-   const char * time_unit;
+   int i;
 
-   if(rt_freq > 1000000) 
+   for(i = 0; i < rt_sink_count; i++)
    {
-      time_scale = 1000000000 / rt_freq;
-      time_unit = "ns";
+      if(rt_sinks[i]->fd == fd)
+         return rt_sinks[i];
    }
-   else if(rt_freq > 1000) 
+   return NULL;
+}
+
+/**
+ * write a buffer in a file, even if the file accepts only a part of it at once
+ */
+static void sink_write(int fd, const char * data, int len)
+{
+   int n;
+
+   while(len > 0)
    {
-      time_scale = 1000000 / rt_freq;
-      time_unit = "us";
+      n = write(fd, data, len);
+      if(n <= 0)
+      {
+         ERROR("Cannot write %d bytes in output %d\n", len, fd);
+         return;
+      }
+      data += n;
+      len  -= n;
    }
-   else
+}
+
+/**
+ * Writer thread: write blocks of its sink in the file, until it is stopped
+ */
+void * sink_writer(void * arg)
+{
+   struct rt_sink * s = (struct rt_sink *)arg;
+   struct rt_block * b;
+   int len, spin;
+
+   while(1)
    {
-      time_scale = 1000 / rt_freq;
-      time_unit = "ms";
-   }
+      for(spin = 0; spin < RT_SINK_SPIN; spin++)
+      {
+         b = (struct rt_block *)ring_pop_slot(&s->ring);
+         if(b)
+            break;
+         sched_yield();
+      }
 
-   write_line(fd, "$date\n");
-   write_line(fd, "   Date text. For example: November 25, 2016.\n");
-   write_line(fd, "$end\n");
-   write_line(fd, "$comment\n");
-   write_line(fd, "%s\n", title);
-   write_line(fd, "$end\n");
-   write_line(fd, "$timescale %d%s $end\n", time_scale, time_unit);
-   return 0;
+      if(b == NULL)
+      {
+         // nothing to write for a while: sleep until sink_flush wakes us up
+         pthread_mutex_lock(&s->lock);
+         __atomic_store_n(&s->sleeping, 1, __ATOMIC_SEQ_CST);
+         while((b = (struct rt_block *)ring_pop_slot(&s->ring)) == NULL)
+            pthread_cond_wait(&s->cond, &s->lock);
+         __atomic_store_n(&s->sleeping, 0, __ATOMIC_SEQ_CST);
+         pthread_mutex_unlock(&s->lock);
+      }
+
+      len = b->len;
+      sink_write(s->fd, b->data, len);
+      ring_pop_commit(&s->ring);
+
+      if(len < 0)
+         break;
+   }
+   return NULL;
 }
 
 /**
-  *  A convenient way to browse easily all objects starting from top
-  *     .--------------------------------------.
-  *     v                                      |
-  *    0)top -> 1)group -> 6)obj -> 7)group --
-  *                |  \-----<-----.
-  *                v              |
-  *             2)obj--> 3)group --
-  *                          |   \----<----.
-  *                          v             |
-  *                        4)obj -> 5)obj --
-  */
-int for_each_object(struct rt_object * obj, iterate_object_t action, void * info)
+ * take the next free block of a threaded sink, waiting for the writer if all blocks are used
+ */
+static void sink_next_block(struct rt_sink * s)
 {
-   struct rt_object * k;
-   list_node_t * node;
-   list_node_t * tmp;
+   while((s->block = (struct rt_block *)ring_push_slot(&s->ring)) == NULL)
+      sched_yield();
+   s->buf = s->block->data;
+}
 
-   // VERB("iter obj %x zombie=%d type=%d name=%s\n", obj->id, obj->zombie, obj->type, obj->name);
-   if(action(obj, 0, info))
-      return 1;
+/**
+ * give the block being filled to the writer, and take the next one
+ */
+static void sink_push_block(struct rt_sink * s, int len)
+{
+   s->block->len = len;
+   ring_push_commit(&s->ring);
 
-   list_for_each_safe(node, tmp, &obj->list)
+   __atomic_thread_fence(__ATOMIC_SEQ_CST);
+   if(__atomic_load_n(&s->sleeping, __ATOMIC_SEQ_CST))
    {
-      k = list_entry(node, struct rt_object, node);
-      if(for_each_object(k, action, info))
-         return 1;
+      pthread_mutex_lock(&s->lock);
+      pthread_cond_signal(&s->cond);
+      pthread_mutex_unlock(&s->lock);
    }
 
-   return action(obj, 1, info);
+   if(len >= 0)
+      sink_next_block(s);
 }
 
 /**
- * An iterator function for msc_dump_start function.
- * Redraw an object following the natural object group order.
+ * write the buffered lines of a sink
  */
-int msc_redraw(struct rt_object * k, int exit, void * info)
+void sink_flush(struct rt_sink * s)
 {
-   struct rt_msg m;
-   object_status_t status;
+   if(s->len == 0)
+      return;
 
-   if(exit || k->zombie)
-      return 0;
+   if(s->threaded)
+      sink_push_block(s, s->len);
+   else
+      sink_write(s->fd, s->buf, s->len);
+   s->len = 0;
+}
 
-   // values that we don't care
-   m.time = 0;
-   m.id2 = 0;
-   m.msc_level = 0;
-   m.vcd_level = 0;
-   m.group = NULL;
-   m.obj1 = NULL;
-   m.obj2 = NULL;
+/**
+ * write the buffered lines of all sinks
+ */
+void sink_flush_all()
+{
+   int i;
 
-   /**
-    * redraw this object instance
-    */
-   switch (k->type)
-   {
-      case RT_TASK:
-         m.cmd = RT_DEF_CMD_DECLTASK;
-         break;
-      case RT_MUTEX:
-         m.cmd = RT_DEF_CMD_DECLMUTEX;
-         break;
-      case RT_OBJECT:
-         m.cmd = RT_DEF_CMD_DECLOBJ;
-         break;
-      default:
-         // other objects are not not msc
-         return 0;
-   }
-   m.id1  = k->oid;
-   m.obj1 = k;
-   string_cpy(m.text, k->name);
-   exec_cmd(&m);
+   for(i = 0; i < rt_sink_count; i++)
+      sink_flush(rt_sinks[i]);
+}
+
+/**
+ * add data to a sink, block by block
+ */
+static void sink_append(struct rt_sink * s, const char * data, int len)
+{
+   int n;
 
-   /**
-    * restore object status (when msc page breaks, all values are drawed as defaut,
-    * RT_OBJECT_READY)
-    */
-   status    = k->status;
-   k->status = RT_OBJECT_INIT;
-   switch (status)
+   while(len > 0)
    {
-      case RT_OBJECT_PREEMPT:
-         m.cmd = RT_DEF_CMD_PREEMPT;
-         break;
-      case RT_OBJECT_RUN:
-         m.cmd = RT_DEF_CMD_RUN;
-         break;
-      case RT_OBJECT_WAIT:
-         m.cmd = RT_DEF_CMD_WAIT;
-         break;
-      case RT_OBJECT_READY:
-         m.cmd = RT_DEF_CMD_READY;
-         break;
-      default:
-         // other objects are not not msc
-         return 0;
+      if(s->len == s->size)
+         sink_flush(s);
+
+      n = s->size - s->len;
+      if(n > len)
+         n = len;
+      mem_cpy(s->buf + s->len, data, n);
+      s->len += n;
+      data   += n;
+      len    -= n;
    }
-   exec_cmd(&m);
-   return 0;
 }
 
 /**
- * end current msc diagram
+ * buffer an output file. With threaded, its blocks are written by a writer thread.
+ * return -1 if memory is missing or if the writer cannot be started, 0 otherwise
  */
-int msc_dump_start(int fd, char * title, rt_time_t time)
+static int sink_create(int fd, int threaded)
 {
-   write_line(fd, "\\begin{msc}{%s}\n", title);
-   write_line(fd, "\\setlength{\\topheaddist}{%dmm}\n",      msc_level_height);
-   write_line(fd, "\\setlength{\\levelheight}{%dmm}\n",      msc_level_height);
-   write_line(fd, "\\setlength{\\bottomfootdist}{%dmm}\n",   msc_level_height);
-   write_line(fd, "\\setlength{\\bottomfootdist}{%dmm}\n",   msc_level_height);
-   write_line(fd, "\\setlength{\\actionheight}{%dmm}\n",     msc_box_height);
-   write_line(fd, "\\setlength{\\conditionheight}{%dmm}\n",  msc_box_height);
-   write_line(fd, "\\setlength{\\instheadheight}{%dmm}\n",   msc_box_height);
-   write_line(fd, "\\setlength{\\firstlevelheight}{%dmm}\n", msc_box_height);
-   write_line(fd, "\\setlength{\\lastlevelheight}{%dmm}\n",  msc_box_height);
-   write_line(fd, "\\setlength{\\instdist}{%dmm}\n",         msc_inst_dist);
-   write_line(fd, "\\setlength{\\envinstdist}{\\instdist}\n");
-   write_line(fd, "\\setlength{\\instfootheight}{%dmm}\n",   3);
-   write_line(fd, "\\setlength{\\markdist}{%dmm}\n",         0);
+   struct rt_sink * s;
 
-   msc_page_instances = 0;
+   if((fd < 0) || sink_get(fd))
+      return 0;
 
-   for_each_object(&top, msc_redraw, NULL);
+   if(rt_sink_count >= (int)(sizeof(rt_sinks) / sizeof(rt_sinks[0])))
+      return -1;
 
-   if(msc_mark_grain == MSC_MARK_GRANULARITY_PAGE) {
-      switch(msc_mark_disp) {
-         case MSC_MARK_DISPLAY_NONE:
-            break;
-         case MSC_MARK_DISPLAY_BOTH:
-            write_line(fd, "\\mscmark[bl]{%d : %d}{envleft}\n", time, msc_level);
-            break;
-         case MSC_MARK_DISPLAY_REALTIME:
-            write_line(fd, "\\mscmark[bl]{%d}{envleft}\n", time);
-            break;
-         case MSC_MARK_DISPLAY_LEVEL:
-            write_line(fd, "\\mscmark[bl]{%d}{envleft}\n", msc_level);
-            break;
+   s = (struct rt_sink *)heap_alloc(sizeof(struct rt_sink));
+   if(s == NULL)
+      return -1;
+
+   s->fd       = fd;
+   s->len      = 0;
+   s->size     = rt_out_buffer;
+   s->threaded = threaded;
+   s->sleeping = 0;
+
+   if(s->threaded)
+   {
+      if(ring_init(&s->ring, RT_SINK_SIZE, sizeof(struct rt_block) + s->size) < 0)
+      {
+         heap_free(s);
+         return -1;
+      }
+      pthread_mutex_init(&s->lock, NULL);
+      pthread_cond_init(&s->cond, NULL);
+
+      if(pthread_create(&s->thread, NULL, sink_writer, s) != 0)
+      {
+         ERROR("Cannot start writer of output %d\n", fd);
+         ring_end(&s->ring);
+         heap_free(s);
+         return -1;
+      }
+      sink_next_block(s);
+   }
+   else
+   {
+      s->buf = (char *)heap_alloc(s->size);
+      if(s->buf == NULL)
+      {
+         heap_free(s);
+         return -1;
       }
    }
 
+   rt_sinks[rt_sink_count++] = s;
    return 0;
 }
 
 /**
- * An iterator function for vcd_start_dump function.
- * Redraw an object following the natural object group order.
+ * buffer an output file. With -writers, its blocks are written by a writer thread.
+ * return -1 if memory is missing or if the writer cannot be started, 0 otherwise
  */
-int vcd_define_symbols(struct rt_object * k, int exit, void * info)
+int sink_open(int fd)
 {
-   struct rt_msg m;
+   return sink_create(fd, rt_writers);
+}
 
-   rt_cmd_t cmd;
+/**
+ * return the offset of the next byte written in a file, buffered bytes included.
+ * The file must not be written by a writer thread.
+ */
+static off_t sink_tell(int fd)
+{
+   struct rt_sink * s = sink_get(fd);
 
-   // values that we don't care
-   m.time = 0;
-   m.id2 = 0;
-   m.msc_level = 0;
-   m.vcd_level = 0;
-   m.obj1 = NULL;
-   m.obj2 = NULL;
+   return lseek(fd, 0, SEEK_CUR) + (s ? s->len : 0);
+}
 
-   // if the declaration of the vcd symbol is already in the vcd_def file, do not redeclare it
-   if(exit)
+/**
+ * append len bytes of the file in, starting at offset off, to an output file
+ */
+static void sink_copy(int out, int in, off_t off, off_t len)
+{
+   struct rt_sink * s = sink_get(out);
+   char buf[4096];
+   ssize_t n;
+
+   while(len > 0)
    {
-      if(k->type == RT_GROUP)
-         cmd = RT_DEF_CMD_DELGRP;
+      n = pread(in, buf, (len < (off_t)sizeof(buf)) ? len : (off_t)sizeof(buf), off);
+      if(n <= 0)
+         return;
+      if(s)
+         sink_append(s, buf, n);
       else
-         return 0;
-   }
-   else
-   {
-      switch (k->type)
-      {
-         case RT_REAL:
-            cmd = RT_DEF_CMD_DECLREAL;
-            break;
-         case RT_REG:
-            cmd = RT_DEF_CMD_DECLREG;
-            break;
-         case RT_PARAM:
-            cmd = RT_DEF_CMD_DECLPARAM;
-            break;
-         case RT_WIRE:
-            cmd = RT_DEF_CMD_DECLWIRE;
-            break;
-         case RT_BOOL:
-            cmd = RT_DEF_CMD_DECLBOOL;
-            break;
-         case RT_TIME:
-            cmd = RT_DEF_CMD_DECLTIME;
-            break;
-         case RT_EVENT:
-            cmd = RT_DEF_CMD_DECLEVENT;
-            break;
-         case RT_STRING:
-            cmd = RT_DEF_CMD_DECLSTRING;
-            break;
-         case RT_INT:
-            cmd = RT_DEF_CMD_DECLINT;
-            break;
-         case RT_TASK:
-            cmd = RT_DEF_CMD_DECLTASK;
-            break;
-         case RT_OBJECT:
-            cmd = RT_DEF_CMD_DECLOBJ;
-            break;
-         case RT_MUTEX:
-            cmd = RT_DEF_CMD_DECLMUTEX;
-            break;
-         case RT_GROUP:
-            cmd = RT_DEF_CMD_CREATGRP;
-            break;
-         default:
-            return 0;
-      }
+         sink_write(out, buf, n);
+      off += n;
+      len -= n;
    }
-
-   m.id1 = k->oid;
-   m.id2 = k->quantification;
-   m.cmd = cmd;
-   string_cpy(m.text, k->name);
-   m.obj1 = k;
-   exec_cmd(&m);
-
-   return 0;
 }
 
 /**
- * Write vcd definitions
+ * write all buffered lines of an output file, and stop its writer. The file is not closed.
  */
-void vcd_write_definitions()
+void sink_close(int fd)
 {
-   int saved_msc = msc_out;
-   int saved_sdl = sdl_out;
+   struct rt_sink * s = sink_get(fd);
+   int i;
 
-   msc_out = 0;
-   sdl_out = 0;
+   if(s == NULL)
+      return;
 
-   INFO("end of vcd definition section\n");
-   vcd_def_out = 1;
-   for_each_object(&top, vcd_define_symbols, NULL);
-   vcd_def_out = 0;
+   sink_flush(s);
 
-   msc_out = saved_msc;
-   sdl_out = saved_sdl;
+   if(s->threaded)
+   {
+      sink_push_block(s, -1);
+      pthread_join(s->thread, NULL);
+      pthread_mutex_destroy(&s->lock);
+      pthread_cond_destroy(&s->cond);
+      ring_end(&s->ring);
+   }
+   else
+   {
+      heap_free(s->buf);
+   }
+
+   for(i = 0; rt_sinks[i] != s; i++);
+   rt_sinks[i] = rt_sinks[--rt_sink_count];
+   heap_free(s);
 }
 
 /**
- * An iterator function for vcd_start_dump function.
- * Redraw an object following the natural object group order.
+ * send one text line to a text file. Lines are not truncated.
  */
-int vcd_reload_values(struct rt_object * k, int exit, void * info)
+int write_line(int fd, char * format, ...)
 {
-   struct rt_msg m;
-
-   rt_cmd_t cmd;
-
-   if(exit)
-      return 0;
+   va_list args;
+   struct rt_sink * s = sink_get(fd);
+   char str[RT_CFG_MAX_COMMAND_LEN];
+   char * tmp;
+   int len;
 
-   // values that we don't care
-   m.time = 0;
-   m.id2 = 0;
-   m.msc_level = 0;
-   m.vcd_level = 0;
-   m.obj1 = NULL;
-   m.obj2 = NULL;
+   if(fd < 0)
+      return -1;
 
-   switch (k->type)
+   if(s == NULL)
    {
-      case RT_REAL:
-         cmd = RT_DEF_CMD_SETREAL;
-         break;
-      case RT_REG:
-         cmd = RT_DEF_CMD_SETREG;
-         break;
-      case RT_PARAM:
-         cmd = RT_DEF_CMD_SETPARAM;
-         break;
-      case RT_WIRE:
-         cmd = RT_DEF_CMD_SETWIRE;
-         break;
-      case RT_BOOL:
-         cmd = RT_DEF_CMD_SETBOOL;
-         break;
-      case RT_TIME:
-         cmd = RT_DEF_CMD_SETTIME;
-         break;
-      case RT_EVENT:
-         cmd = RT_DEF_CMD_SETEVENT;
-         break;
-      case RT_STRING:
-         cmd = RT_DEF_CMD_SETSTRING;
-         break;
-      case RT_INT:
-         cmd = RT_DEF_CMD_SETINT;
-         break;
-      case RT_TASK:
-      case RT_OBJECT:
-         cmd = RT_DEF_CMD_SETSTATE;
-         break;
-      default:
-         return 0;
+      va_start (args, format);
+      len = string_vnprintf(str, sizeof(str), format, args);
+      va_end (args);
+      if(len < (int)sizeof(str))
+         return write(fd, str, len);
+
+      tmp = (char *)heap_alloc(len + 1);
+      if(tmp == NULL)
+         return -1;
+      va_start (args, format);
+      string_vnprintf(tmp, len + 1, format, args);
+      va_end (args);
+      len = write(fd, tmp, len);
+      heap_free(tmp);
+      return len;
    }
-   m.id1  = k->oid;
-   m.cmd  = cmd;
-   m.obj1 = k;
 
-   switch (k->type)
+   // format in place. The line is formatted again if it does not fit at the end of the buffer
+   va_start (args, format);
+   len = string_vnprintf(s->buf + s->len, s->size - s->len, format, args);
+   va_end (args);
+   if(len < s->size - s->len)
    {
-      case RT_STRING:
-      case RT_TASK:
-      case RT_OBJECT:
-         m.id2 = 0;
-         string_cpy(m.text, (char *)k->value);
-         break;
-      default:
-         m.id2 = k->value;
-         string_cpy(m.text, "");
-         break;
+      s->len += len;
+      return len;
    }
-   exec_cmd(&m);
 
-   /**
-    * restore object status (when msc page breaks, all values are drawed as defaut,
-    * RT_OBJECT_READY)
-    */
-   if (k->type == RT_TASK || k->type == RT_OBJECT)
+   sink_flush(s);
+   if(len < s->size)
    {
-      object_status_t status = k->status;
-
-      k->status = RT_OBJECT_INIT; // force redraw of the status
-
-      switch (status)
-      {
-         case RT_OBJECT_PREEMPT:
-            m.cmd = RT_DEF_CMD_PREEMPT;
-            break;
-         case RT_OBJECT_RUN:
-            m.cmd = RT_DEF_CMD_RUN;
-            break;
-         case RT_OBJECT_WAIT:
-            m.cmd = RT_DEF_CMD_WAIT;
-            break;
-         case RT_OBJECT_READY:
-            m.cmd = RT_DEF_CMD_READY;
-            break;
-         case RT_OBJECT_INIT:
-            return 0;
-      }
-
-      exec_cmd(&m);
+      va_start (args, format);
+      string_vnprintf(s->buf, s->size, format, args);
+      va_end (args);
+      s->len = len;
+      return len;
    }
-   return 0;
+
+   // the line is longer than a whole buffer
+   tmp = (char *)heap_alloc(len + 1);
+   if(tmp == NULL)
+      return -1;
+   va_start (args, format);
+   string_vnprintf(tmp, len + 1, format, args);
+   va_end (args);
+   sink_append(s, tmp, len);
+   heap_free(tmp);
+   return len;
 }
 
 /**
- * at the time we reenable the logs, all values must be updated with the internal values stored while the logs
- * where disabled.
+ * Fast path of write_line for value changes of scalar vcd signals: "<value><kind><id>\n", or "<value><kind><id> $end\n"
+ * when end is set. id is written in hexadecimal, like "%x".
  */
-int vcd_dump_start(int fd, rt_time_t time)
+int write_scalar(int fd, char value, char kind, const void * id, int end)
 {
-   int saved_msc = msc_out;
-   int saved_sdl = sdl_out;
-
-   msc_out = 0;
-   sdl_out = 0;
+   static const char hex[] = "0123456789abcdef";
+   struct rt_sink * s = sink_get(fd);
+   uint32_t v = (uint32_t)(uintptr_t)id;
+   char str[16];
+   char * p;
+   int len, n;
 
-   // indicate the new time where dump restart
-   if(vcd_level > 0)
-      write_line(vcd_fd, "#%d\n", vcd_level);
+   if(fd < 0)
+      return -1;
 
-   // restore current values
-   for_each_object(&top, vcd_reload_values, NULL);
+   if((s == NULL) || (s->size - s->len < (int)sizeof(str)))
+      p = str;
+   else
+      p = s->buf + s->len;
 
-   msc_out = saved_msc;
-   sdl_out = saved_sdl;
+   p[0] = value;
+   p[1] = kind;
+   len = 2;
+   for(n = 28; (n > 0) && ((v >> n) == 0); n -= 4);
+   for(; n >= 0; n -= 4)
+      p[len++] = hex[(v >> n) & 0xf];
+   if(end)
+   {
+      mem_cpy(p + len, " $end", 5);
+      len += 5;
+   }
+   p[len++] = '\n';
 
-   return 0;
+   if(s == NULL)
+      return write(fd, p, len);
+   if(p == str)
+      sink_append(s, str, len);
+   else
+      s->len += len;
+   return len;
 }
 
 /**
- * end current msc diagram
+ * Fast path of write_line for vcd time stamps: "#<time>\n"
  */
-int msc_dump_stop(int fd, rt_time_t time)
+int write_time(int fd, int time)
 {
-   if(msc_mark_grain == MSC_MARK_GRANULARITY_PAGE) {
-      switch(msc_mark_disp) {
-         case MSC_MARK_DISPLAY_NONE:
-            break;
-         case MSC_MARK_DISPLAY_BOTH:
-            write_line(fd, "\\mscmark[tl]{%d : %d}{envleft}\n", time, msc_level);
-            break;
-         case MSC_MARK_DISPLAY_REALTIME:
-            write_line(fd, "\\mscmark[tl]{%d}{envleft}\n", time);
-            break;
-         case MSC_MARK_DISPLAY_LEVEL:
-            write_line(fd, "\\mscmark[tl]{%d}{envleft}\n", msc_level);
-            break;
-      }
-   }
+   char str[16];
+   char * p = str + sizeof(str);
+   uint32_t v = (time < 0) ? -(uint32_t)time : (uint32_t)time;
+   struct rt_sink * s = sink_get(fd);
 
-   write_line(fd, "\\end{msc}\n");
+   if(fd < 0)
+      return -1;
 
-   if(msc_page_instances > msc_max_instances)
-      msc_max_instances = msc_page_instances;
+   *--p = '\n';
+   do
+   {
+      *--p = '0' + v % 10;
+      v /= 10;
+   }
+   while(v);
+   if(time < 0)
+      *--p = '-';
+   *--p = '#';
 
-   return 0;
+   if(s == NULL)
+      return write(fd, p, str + sizeof(str) - p);
+   sink_append(s, p, str + sizeof(str) - p);
+   return str + sizeof(str) - p;
 }
 
+/**
+ * msc document preamble, before the paper size
+ */
+static const char msc_doc_head[] = "\\documentclass{article}\n\\usepackage{msc}\n\\usepackage{geometry}\n";
 
 /**
- * end current document
+ * paper size of the msc document. Numbers have a fixed width, so that the line can be overwritten once the
+ * size is known. TeX skips the leading spaces of numbers.
  */
-int msc_end_doc(int fd)
+#define MSC_DOC_GEOMETRY "\\geometry{paperwidth=%6dmm, paperheight=%6dmm}\n"
+
+/**
+ * init msc latex document
+ */
+int msc_new_doc(int fd)
 {
-   write_line(fd, "\\end{document}\n");
+   write_line(fd, "%s", msc_doc_head);
+   write_line(fd, MSC_DOC_GEOMETRY, 0, 0);
+   write_line(fd, "\\geometry{top=1cm, bottom=1cm, left=1cm , right=1cm}\n");
+   write_line(fd, "\\begin{document}\n");
    return 0;
 }
 
 /**
- * read one block of binary data from a binary file.
- * Each data block has a 8 bit header indicating the length of the data block that follow.
+ * write the paper size of the msc document in place, at the end of the simulation
+ * return -1 if the file cannot be written, 0 otherwise
  */
-int read_data(int fd, char * buffer, size_t max)
+int msc_set_geometry(int fd, int width, int height)
 {
-   int rem_len, len;
-   int rc;
-
-   /* read header length */
-   if(read(fd, buffer, 1) < 0)
-      return -1;
-
-   len = rem_len = buffer[0];
-
-   if((rem_len == 0) || (rem_len > max))
-      return -1;
-
-   while(rem_len > 0)
-   {
-      rc = read(fd, buffer, rem_len);
-      if(rc <= 0) 
-         return -1;
-
-      buffer += rc;
-      rem_len -= rc;
-   }
+   char str[RT_CFG_MAX_COMMAND_LEN];
+   int len = string_printf(str, MSC_DOC_GEOMETRY, width, height);
 
-   return len;
+   return (pwrite(fd, str, len, sizeof(msc_doc_head) - 1) == len) ? 0 : -1;
 }
 
 /**
- * read one line in a text file. The line is supposed to finished with '\n'. This character is replaced by a zero instead.
- * if max is reached before the end of the file, return the read len
- * if end of file is reached, return the actual len, but the string is not NULL terminated
- * else return a null terminated string, the '\n' havinf being removed. 
+ * init vcd document
  */
-int read_line(int fd, char * buffer, size_t max)
+int vcd_new_doc(int fd, char * title)
 {
-   int len = 0;
-   int rc;
+   long int time_scale = 0;
+   const char * time_unit;
 
-   while(len < max)
+   if(rt_freq > 1000000) 
    {
-      rc = read(fd, buffer, 1);
-      if(rc <= 0) 
-         break;
-
-      len += 1;
-
-      if(*buffer == '\n')
-      {
-         *buffer = '\0';
-         break;
-      }
-
-      buffer++;
+      time_scale = 1000000000 / rt_freq;
+      time_unit = "ns";
+   }
+   else if(rt_freq > 1000) 
+   {
+      time_scale = 1000000 / rt_freq;
+      time_unit = "us";
+   }
+   else
+   {
+      time_scale = 1000 / rt_freq;
+      time_unit = "ms";
    }
-   return len;
-}
-
 
-/**
- * Display the content of a message.
- * For debug only.
- */
-void print_msg(struct rt_msg * m)
-{
-   fprintf(stdout, "cmd  %d (%s)", m->cmd, rt_cmd_name(m->cmd));
-   fprintf(stdout, ", time %d", m->time);
-   fprintf(stdout, ", gid  %lx", m->gid);
-   fprintf(stdout, ", fid  %x", m->fid);
-   fprintf(stdout, ", id1  %lx", m->id1);
-   fprintf(stdout, ", id2  %lx", m->id2);
-   fprintf(stdout, ", text '%s'\n", m->text);
+   write_line(fd, "$date\n");
+   write_line(fd, "   Date text. For example: November 25, 2016.\n");
+   write_line(fd, "$end\n");
+   write_line(fd, "$comment\n");
+   write_line(fd, "%s\n", title);
+   write_line(fd, "$end\n");
+   write_line(fd, "$timescale %d%s $end\n", time_scale, time_unit);
+   return 0;
 }
 
 /**
- * Find a simular message to the one passed as argument
- * - id1 and id2 must match
- * - text must match
- *
- * Note: the cmd don't care
- */
-struct rt_msg * msc_find_msg(struct rt_msg * m)
+  *  A convenient way to browse easily all objects starting from top
+  *     .--------------------------------------.
+  *     v                                      |
+  *    0)top -> 1)group -> 6)obj -> 7)group --
+  *                |  \-----<-----.
+  *                v              |
+  *             2)obj--> 3)group --
+  *                          |   \----<----.
+  *                          v             |
+  *                        4)obj -> 5)obj --
+  */
+int for_each_object(struct rt_object * obj, iterate_object_t action, void * info)
 {
+   struct rt_object * k;
    list_node_t * node;
-   struct rt_msg * k;
-	 struct rt_object * obj1 = find_object(m->fid, m->id1);
-	 if(!obj1)
-		 return NULL;
-	 struct rt_object * obj2 = find_object(m->fid, m->id2);
-	 if(!obj2)
-		 return NULL;
-   list_for_each(node, &rt_queue)
-   {
-      k = list_entry(node, struct rt_msg, node);
-      if( (string_cmp(k->text, m->text) == 0)
-	     && (find_object(k->fid, k->id1) == obj1) 
-       && (find_object(k->fid, k->id2) == obj2))
-      {
-         return k;
-      }
-   }
-   return NULL;
-}
+   list_node_t * tmp;
 
-void exec_decltask(struct rt_msg * m)
-{
-   m->obj1->quantification = 0;
-   if(msc_out)
-   {
-      msc_page_instances++;
-      write_line(msc_fd, "\\declinst{%x}{task}{%s}\n", m->obj1, m->text);
-   }
-   if(sdl_out)
+   // VERB("iter obj %x zombie=%d type=%d name=%s\n", obj->id, obj->zombie, obj->type, obj->name);
+   if(action(obj, 0, info))
+      return 1;
+
+   list_for_each_safe(node, tmp, &obj->list)
    {
+      k = list_entry(node, struct rt_object, node);
+      if(for_each_object(k, action, info))
+         return 1;
    }
-   if(vcd_def_out)
-   {
-      // status of the process at os level
-      write_line(vcd_def_fd, "$var wire 1 ^%x %s->task $end\n", m->obj1, m->obj1->key);
 
-      // state of the process
-      write_line(vcd_def_fd, "$var string 0 $%x %s->state $end\n", m->obj1, m->obj1->key);
-   }
+   return action(obj, 1, info);
 }
 
-void exec_declmutex(struct rt_msg * m)
+/**
+ * Flat view of some objects of the tree, in group order, as parallel arrays. Page breaks and vcd restarts scan
+ * a view instead of walking the tree.
+ */
+struct rt_view
 {
-   if(msc_out)
-   {
-      msc_page_instances++;
-      write_line(msc_fd, "\\declinst{%x}{mutex}{%s}\n", m->obj1, m->text);
-   }
-   if(sdl_out)
-   {
-   }
-   if(vcd_def_out)
-   {
-      // status of the mutex
-      write_line(vcd_def_fd, "$var wire 1 ^%x %s $end\n", m->obj1, m->obj1->key);
-   }
-}
+   int                 count;  /// number of objects
+   int                 size;   /// size of the arrays
+   struct rt_object ** obj;    /// objects
+   uint8_t           * cmd;    /// command declaring (msc) or setting (vcd) each object
+};
 
-void exec_declobj(struct rt_msg * m)
+/**
+ * living msc instances, and vcd variables. Zombies keep their vcd symbol, so they stay in the vcd view.
+ */
+static struct rt_view msc_view;
+static struct rt_view vcd_view;
+
+/**
+ * command declaring an msc instance of a type, RT_DEF_CMD_MAX if the type is not an msc instance
+ */
+static rt_cmd_t msc_decl_cmd(object_type_t type)
 {
-   char *p = m->text;
-   char *inst_name;
-   char *inst_type;
-   inst_type = string_sep(&p, "\t ");
-   inst_name = string_sep(&p, "\t ");
-   m->obj1->quantification = 0;
-   if(msc_out)
-   {
-      msc_page_instances++;
-      write_line(msc_fd, "\\declinst{%x}{%s}{%s}\n", m->obj1, inst_type, inst_name);
-   }
-   if(sdl_out)
+   switch (type)
    {
+      case RT_TASK:   return RT_DEF_CMD_DECLTASK;
+      case RT_MUTEX:  return RT_DEF_CMD_DECLMUTEX;
+      case RT_OBJECT: return RT_DEF_CMD_DECLOBJ;
+      default:        return RT_DEF_CMD_MAX;
    }
-   if(vcd_def_out)
-   {
-      // status of the object
-      write_line(vcd_def_fd, "$var wire 1 ^%x %s->call $end\n", m->obj1, inst_name);
+}
 
-      // state of the object.
-      write_line(vcd_def_fd, "$var string 0 $%x %s->state $end\n", m->obj1, inst_name);
+/**
+ * command setting the value of a vcd variable of a type, RT_DEF_CMD_MAX if the type has no value
+ */
+static rt_cmd_t vcd_set_cmd(object_type_t type)
+{
+   switch (type)
+   {
+      case RT_REAL:   return RT_DEF_CMD_SETREAL;
+      case RT_REG:    return RT_DEF_CMD_SETREG;
+      case RT_PARAM:  return RT_DEF_CMD_SETPARAM;
+      case RT_WIRE:   return RT_DEF_CMD_SETWIRE;
+      case RT_BOOL:   return RT_DEF_CMD_SETBOOL;
+      case RT_TIME:   return RT_DEF_CMD_SETTIME;
+      case RT_EVENT:  return RT_DEF_CMD_SETEVENT;
+      case RT_STRING: return RT_DEF_CMD_SETSTRING;
+      case RT_INT:    return RT_DEF_CMD_SETINT;
+      case RT_TASK:
+      case RT_OBJECT: return RT_DEF_CMD_SETSTATE;
+      default:        return RT_DEF_CMD_MAX;
    }
 }
 
 /**
- * find a similar message.
- * Apply only to the following messages:
- *    - RT_DEF_CMD_SENDMSG
- *    - RT_DEF_CMD_SETTIMER
- * If message is correlated to one message of the queue, the following fields are changed:
- *    - m->off is set to k->time - m->time
- *    - m->corr is set to k
- *    - k->corr is set to m
- *    - k->off is set to - m->off
- *    - 1 is returned
- * Else:
- *    - 0 is returned
+ * make room in a view for one more object
+ * return -1 if memory is missing, 0 otherwise
  */
-int msc_find_corr(struct rt_msg * m)
+static int rt_view_reserve(struct rt_view * v)
 {
-   struct rt_msg * k;
-
-   if ((m->cmd == RT_DEF_CMD_SENDMSG) || (m->cmd == RT_DEF_CMD_SETTIMER))
+   if(v->count == v->size)
    {
-      k = msc_find_msg(m);
+      int size = v->size ? 2 * v->size : 64;
+      struct rt_object ** obj = (struct rt_object **)heap_realloc(v->obj, size * sizeof(struct rt_object *));
+      uint8_t * c;
 
-      // if message is lost, offset is kept to -1
-      if (k)
-      {
-         // logical order: the received message should have a reception time more recent (or =)
-         if (k->time < m->time)
-         {
-            ERROR("logical condition broken\n");
-            ERROR(" => recvmsg:\n");
-            print_msg(k);
-            ERROR(" => sendmsg:\n");
-            print_msg(m);
-         }
-         else
-         {
-					 	INFO("correlation found");
-            m->off  = msc_get_time(k) - msc_get_time(m);
-            k->off  = -m->off;
-            k->corr = m;
-            m->corr = k;
-            return 1;
-         }
-      }
+      if(obj == NULL)
+         return -1;
+      v->obj = obj;
+      c = (uint8_t *)heap_realloc(v->cmd, size);
+      if(c == NULL)
+         return -1;
+      v->cmd  = c;
+      v->size = size;
    }
    return 0;
 }
 
-void exec_sendmsg(struct rt_msg * m)
+/**
+ * number of groups above an object
+ */
+static inline int rt_view_depth(struct rt_object * k)
 {
-   if(msc_out)
-   {
-      if(m->corr == NULL)
-         write_line(msc_fd, "\\lost[r]{%s}{}{%x}\n", m->text, m->obj1);
-      else
-         write_line(msc_fd, "\\mess{%s}{%x}[0.1]{%x}[%d]\n", m->text, m->obj1, m->obj2, m->off);
-   }
-   if(sdl_out)
-   {
-   }
-   if(vcd_out)
-   {
-   }
+   int depth = 0;
+
+   for(; k->group; k = k->group)
+      depth++;
+   return depth;
 }
 
-void exec_call(struct rt_msg * m)
+/**
+ * 1 if a is before b in group order. Objects are appended to their group and never move, so sibling objects
+ * are in the order of their uids.
+ */
+static int rt_view_before(struct rt_object * a, struct rt_object * b)
 {
-   if(msc_out)
+   int da = rt_view_depth(a);
+   int db = rt_view_depth(b);
+
+   for(; da > db; da--)
    {
-      write_line(msc_fd, "\\mess{%s}{%x}{%x}\n", m->text, m->obj1, m->obj2);
-      if(m->obj2->status != RT_OBJECT_RUN)
-         write_line(msc_fd, "\\regionstart{activation}{%x}\n", m->obj2);
+      if(a->group == b)
+         return 0;
+      a = a->group;
    }
-   if(sdl_out)
+   for(; db > da; db--)
    {
+      if(b->group == a)
+         return 1;
+      b = b->group;
    }
-   if(vcd_out)
+   while(a->group != b->group)
    {
-      if(m->obj2->status != RT_OBJECT_RUN)
-         write_line(vcd_fd, "1^%x $end\n", m->obj2);
+      a = a->group;
+      b = b->group;
    }
-   m->obj2->status = RT_OBJECT_RUN;
+   return a->uid < b->uid;
 }
 
-void exec_recvmsg(struct rt_msg * m)
+/**
+ * return the place of an object in a view, in group order
+ */
+static int rt_view_find(struct rt_view * v, struct rt_object * k)
 {
-   if(msc_out)
-   {
-      if(m->corr == NULL)
-         write_line(msc_fd, "\\found[r]{%s}{}{%x}\n", m->text, m->obj1);
-   }
-   if(sdl_out)
-   {
-   }
-   if(vcd_out)
+   int lo = 0;
+   int hi = v->count;
+
+   while(lo < hi)
    {
+      int mid = lo + (hi - lo) / 2;
+      if(rt_view_before(v->obj[mid], k))
+         lo = mid + 1;
+      else
+         hi = mid;
    }
+   return lo;
 }
 
-void exec_sleep(struct rt_msg * m)
+/**
+ * insert an object in a view at its place. New objects are the last ones of their group, most often the last
+ * ones of the view.
+ */
+static void rt_view_put(struct rt_view * v, struct rt_object * k, rt_cmd_t cmd)
 {
-   if(msc_out)
-   {
-      if(m->obj1->status != RT_OBJECT_WAIT)
-         write_line(msc_fd, "\\regionstart{coregion}{%x}\n", m->obj1);
-   }
-   if(sdl_out)
-   {
-   }
-   if(vcd_out)
+   int i;
+
+   if(rt_view_reserve(v) < 0)
    {
-      if(m->obj1->status != RT_OBJECT_WAIT)
-         write_line(vcd_fd, "1^%x $end\n", m->obj1);
+      ERROR("Cannot add object '%s' to a view, views are rebuilt\n", text_str(k->name));
+      rt_view_dirty = 1;
+      return;
    }
 
-   m->obj1->status = RT_OBJECT_WAIT;
+   i = ((v->count == 0) || rt_view_before(v->obj[v->count - 1], k)) ? v->count : rt_view_find(v, k);
+   mem_move(v->obj + i + 1, v->obj + i, (v->count - i) * sizeof(struct rt_object *));
+   mem_move(v->cmd + i + 1, v->cmd + i, v->count - i);
+   v->obj[i] = k;
+   v->cmd[i] = cmd;
+   v->count++;
 }
 
-void exec_switch(struct rt_msg * m)
+/**
+ * remove an object from a view, if it is in it
+ */
+static void rt_view_del(struct rt_view * v, struct rt_object * k)
 {
-   if(msc_out)
-   {
-      write_line(msc_fd, "\\mess*{switch}{%x}{%x}\n", m->obj1, m->obj2);
-   }
-   if(sdl_out)
-   {
-   }
-   if(vcd_out)
+   int i = rt_view_find(v, k);
+
+   if((i < v->count) && (v->obj[i] == k))
    {
+      v->count--;
+      mem_move(v->obj + i, v->obj + i + 1, (v->count - i) * sizeof(struct rt_object *));
+      mem_move(v->cmd + i, v->cmd + i + 1, v->count - i);
    }
 }
 
-void exec_return(struct rt_msg * m)
+/**
+ * add a new or revived object to the views. A revived zombie is only added to the msc view.
+ */
+void rt_view_insert(struct rt_object * k, int msc_only)
 {
-   if(msc_out)
-   {
-      write_line(msc_fd, "\\order{%x}{%x}\n", m->obj1, m->obj2);
-      if(m->obj1->status == RT_OBJECT_RUN)
-         write_line(msc_fd, "\\regionend{%x}\n", m->obj1);
-   }
-   if(sdl_out)
-   {
-   }
-   if(vcd_out)
-   {
-      if(m->obj1->status == RT_OBJECT_RUN)
-         write_line(vcd_fd, "0^%x $end\n", m->obj1);
-   }
-   m->obj1->status = RT_OBJECT_READY;
+   rt_cmd_t cmd;
+
+   if(rt_view_dirty)
+      return;
+
+   cmd = msc_decl_cmd(k->type);
+   if(cmd != RT_DEF_CMD_MAX)
+      rt_view_put(&msc_view, k, cmd);
+
+   cmd = vcd_set_cmd(k->type);
+   if((cmd != RT_DEF_CMD_MAX) && !msc_only)
+      rt_view_put(&vcd_view, k, cmd);
 }
 
-void exec_comment(struct rt_msg * m)
+/**
+ * remove a deleted object from the views. A zombie is only removed from the msc view.
+ */
+void rt_view_remove(struct rt_object * k, int msc_only)
 {
-   if(msc_out)
-   {
-      write_line(msc_fd, "\\msccomment[%c]{%s}{%x}\n", 'r', m->text, m->obj1);
-   }
-   if(sdl_out)
-   {
-   }
-   if(vcd_out)
-   {
-   }
+   if(rt_view_dirty)
+      return;
+
+   if(msc_decl_cmd(k->type) != RT_DEF_CMD_MAX)
+      rt_view_del(&msc_view, k);
+   if((vcd_set_cmd(k->type) != RT_DEF_CMD_MAX) && !msc_only)
+      rt_view_del(&vcd_view, k);
 }
 
-void exec_action(struct rt_msg * m)
+/**
+ * append an object to a view being rebuilt
+ * return -1 if memory is missing, 0 otherwise
+ */
+static int rt_view_add(struct rt_view * v, struct rt_object * k, rt_cmd_t cmd)
 {
-   if(msc_out)
-   {
-      write_line(msc_fd, "\\action*{%s}{%x}\n", m->text, m->obj1);
-   }
-   if(sdl_out)
-   {
-   }
-   if(vcd_out)
-   {
-   }
+   if(rt_view_reserve(v) < 0)
+      return -1;
+   v->obj[v->count] = k;
+   v->cmd[v->count] = cmd;
+   v->count++;
+   return 0;
 }
 
-void exec_settimer(struct rt_msg * m)
+/**
+ * An iterator function for rt_view_update function.
+ */
+static int rt_view_iterator(struct rt_object * k, int exit, void * info)
 {
-   if(msc_out)
-   {
-      if(m->corr == NULL)
-         write_line(msc_fd, "\\settimer[r]{%s}{%x}\n", m->text, m->obj1);
-      else if(m->corr->cmd == RT_DEF_CMD_TIMEOUT)
-         write_line(msc_fd, "\\settimeout[r]{%s}{%x}[%d]\n", m->text, m->obj1, m->off);
-      else if(m->corr->cmd == RT_DEF_CMD_STOPTIMER)
-         write_line(msc_fd, "\\setstoptimer[r]{%s}{%x}[%d]\n", m->text, m->obj1, m->off);
-   }
+   rt_cmd_t cmd;
 
-   if(msc_out)
-   {
-   }
-   if(sdl_out)
-   {
-   }
-   if(vcd_out)
-   {
-   }
+   if(exit)
+      return 0;
+
+   cmd = msc_decl_cmd(k->type);
+   if((cmd != RT_DEF_CMD_MAX) && !k->zombie && (rt_view_add(&msc_view, k, cmd) < 0))
+      return 1;
+
+   cmd = vcd_set_cmd(k->type);
+   if((cmd != RT_DEF_CMD_MAX) && (rt_view_add(&vcd_view, k, cmd) < 0))
+      return 1;
+
+   return 0;
 }
 
-void exec_exptimer(struct rt_msg * m)
+/**
+ * Rebuild the views, if they could not follow the changes of the object tree. Otherwise they are kept in group
+ * order as objects are created, deleted or revived.
+ */
+static void rt_view_update(void)
 {
-   if(msc_out)
-   {
-      if(m->corr == NULL)
-         write_line(msc_fd, "\\timeout[r]{%s}{%x}\n", m->text, m->obj1);
-   }
-   if(sdl_out)
-   {
-   }
-   if(vcd_out)
+   if(!rt_view_dirty)
+      return;
+
+   msc_view.count = 0;
+   vcd_view.count = 0;
+   if(for_each_object(&top, rt_view_iterator, NULL))
    {
+      ERROR("Cannot rebuild the object views\n");
+      return;
    }
+   rt_view_dirty = 0;
 }
 
-void exec_stoptimer(struct rt_msg * m)
+/**
+ * With -msc_cull or -msc_page_max_instances, an msc page is written in a buffer file, then copied in the document
+ * without the instances it does not use, on one sheet or more. The lines drawing each instance at the start of the
+ * page are a segment of the buffer file.
+ */
+struct msc_seg
 {
-   if(msc_out)
-   {
-      if(m->corr == NULL)
-         write_line(msc_fd, "\\stoptimer[r]{%s}{%x}\n", m->text, m->obj1);
-   }
-   if(sdl_out)
-   {
-   }
-   if(vcd_out)
-   {
-   }
-}
+   off_t    off;   /// offset of the lines in the buffer file
+   int      len;   /// length of the lines
+   int      used;  /// not 0 if the page references the instance, then rank of the instance on the page
+   uint32_t uid;   /// instance
+};
 
-void exec_ready(struct rt_msg * m)
+/**
+ * buffer file of the current page, and document the page is copied to
+ */
+int msc_page_fd = -1;
+int msc_page_doc = -1;
+
+/**
+ * segments of the instances drawn at the start of the current page, offset of these segments after the page
+ * header, and offset of the page body after them
+ */
+struct msc_seg * msc_segs = NULL;
+int              msc_seg_count = 0;
+int              msc_seg_size = 0;
+off_t            msc_page_head = 0;
+off_t            msc_page_body = 0;
+
+/**
+ * number of pages started, to know if the segment of an object belongs to the current page
+ */
+uint32_t msc_page_serial = 0;
+
+/**
+ * create the buffer file of msc pages
+ * return -1 if the file cannot be created, 0 otherwise
+ */
+int msc_page_open(void)
 {
-   if(msc_out)
-   {
-      if(m->obj1->status != RT_OBJECT_READY)
-         write_line(msc_fd, "\\regionend{%x}\n", m->obj1);
-   }
-   if(sdl_out)
-   {
-   }
-   if(vcd_out)
-   {
-      if(m->obj1->status != RT_OBJECT_READY)
-         write_line(vcd_fd, "0^%x $end\n", m->obj1);
-   }
+   msc_page_fd = memfd_create("msc_page", 0);
+   if(msc_page_fd < 0)
+      return -1;
 
-   m->obj1->status = RT_OBJECT_READY;
+   // the page is read back when it ends, so its lines are never written by a thread
+   return sink_create(msc_page_fd, 0);
 }
 
-void exec_suspend(struct rt_msg * m)
+/**
+ * start writing the msc lines of a page in the buffer file
+ */
+void msc_page_capture(void)
 {
-   if(msc_out)
-   {
-      if(m->obj1->status != RT_OBJECT_PREEMPT)
-         write_line(msc_fd, "\\regionstart{suspension}{%x}\n", m->obj1);
-   }
-   if(sdl_out)
-   {
-   }
-   if(vcd_out)
-   {
-      if(m->obj1->status != RT_OBJECT_PREEMPT)
-         write_line(vcd_fd, "x^%x $end\n", m->obj1);
-   }
-   m->obj1->status = RT_OBJECT_PREEMPT;
+   msc_page_doc = msc_fd;
+   msc_fd       = msc_page_fd;
+
+   msc_page_serial++;
+   msc_seg_count = 0;
 }
 
-void exec_creattask(struct rt_msg * m)
+/**
+ * record the segment of an instance drawn from offset off of the buffer file
+ */
+void msc_seg_add(struct rt_object * k, off_t off)
 {
-   if(msc_out)
-   {
-      msc_page_instances++;
-      write_line(msc_fd, "\\dummyinst{%x}\n", m->obj2);
-      write_line(msc_fd, "\\create{spawn}[t]{%x}[0.5]{%x}{task}{%s}\n", m->obj1, m->obj2, m->text);
-   }
-   if(sdl_out)
-   {
-   }
-   if(vcd_def_out)
-   {
-      // status of the process
-      write_line(vcd_def_fd, "$var wire 1 ^%x %s->task $end\n", m->obj2, m->obj2->key);
+   struct msc_seg * seg;
 
-      // value (user state) of the process
-      write_line(vcd_def_fd, "$var string 0 $%x %s->state $end\n", m->obj2, m->obj2->key);
-   }
-   if(vcd_out)
+   if(msc_seg_count == msc_seg_size)
    {
-      // dynamically created task are ready
-      write_line(vcd_fd, "0^%x $end\n", m->obj2);
+      seg = (struct msc_seg *)heap_realloc(msc_segs, (msc_seg_size + 64) * sizeof(struct msc_seg));
+      if(seg == NULL)
+         return;
+      msc_segs      = seg;
+      msc_seg_size += 64;
    }
+
+   seg       = &msc_segs[msc_seg_count];
+   seg->off  = off;
+   seg->len  = sink_tell(msc_fd) - off;
+   seg->used = 0;
+   seg->uid  = k->uid;
+
+   k->msc_seg      = msc_seg_count++;
+   k->msc_seg_page = msc_page_serial;
 }
 
-void exec_creatmutex(struct rt_msg * m)
+/**
+ * keep an instance on the current page
+ */
+static inline void msc_use(struct rt_object * k)
 {
-   if(msc_out)
-   {
-      msc_page_instances++;
-      write_line(msc_fd, "\\dummyinst{%x}\n", m->obj2);
-      write_line(msc_fd, "\\create{}[t]{%x}[0.5]{%x}{mutex}{%s}\n", m->obj1, m->obj2, m->text);
-   }
-   if(sdl_out)
-   {
-   }
-   if(vcd_def_out)
-   {
-      // status of the mutex
-      write_line(vcd_def_fd, "$var wire 1 ^%x %s $end\n", m->obj2, m->obj2->key);
-   }
-   if(vcd_out)
-   {
-      write_line(vcd_fd, "0^%x $end\n", m->obj2);
-   }
+   if(msc_buffered && k && (k->msc_seg_page == msc_page_serial))
+      msc_segs[k->msc_seg].used = 1;
 }
 
-void exec_creatobj(struct rt_msg * m)
+/**
+ * maximum number of {} arguments of an msc line
+ */
+#define MSC_LINE_ARGS 8
+
+/**
+ * an msc line, \cmd[opt]{arg}[opt]{arg}... Only {} arguments are kept, with the [] argument following each one
+ */
+struct msc_line
 {
-   char *p = m->text;
-   char *inst_name;
-   char *inst_type;
-   inst_type = string_sep(&p, "\t ");
-   inst_name = string_sep(&p, "\t ");
-   if(msc_out)
-   {
-      msc_page_instances++;
-      write_line(msc_fd, "\\dummyinst{%x}\n", m->obj2);
-      write_line(msc_fd, "\\create{}[t]{%x}[0.5]{%x}{%s}{%s}\n", m->obj1, m->obj2, inst_name, inst_type);
-   }
-   if(sdl_out)
-   {
-   }
-   if(vcd_def_out)
-   {
-      // status of the object
-      write_line(vcd_def_fd, "$var wire 1 ^%x %s->call $end\n", m->obj2, inst_name);
+   const char * cmd;                  /// command name, star included
+   int          cmd_len;
+   const char * lead;                 /// [] argument before the first {} argument, or NULL
+   int          argc;                 /// number of {} arguments
+   const char * arg[MSC_LINE_ARGS];
+   int          len[MSC_LINE_ARGS];
+   const char * opt[MSC_LINE_ARGS];   /// [] argument following arg, or NULL
+};
 
-      // value (user state) of the object.
-      write_line(vcd_def_fd, "$var string 0 $%x %s->state $end\n", m->obj2, inst_name);
-   }
-   if(vcd_out)
-   {
-      write_line(vcd_fd, "0^%x $end\n", m->obj2);
-   }
+/**
+ * {} arguments of msc commands that are instance names, as a bit mask
+ */
+static const struct
+{
+   const char * cmd;
+   int          inst;
 }
+msc_line_inst[] =
+{
+   { "declinst",     0x1 },
+   { "dummyinst",    0x1 },
+   { "create",       0x6 },
+   { "stop",         0x1 },
+   { "mess",         0x6 },
+   { "mess*",        0x6 },
+   { "lost",         0x4 },
+   { "found",        0x4 },
+   { "order",        0x3 },
+   { "regionstart",  0x2 },
+   { "regionend",    0x1 },
+   { "msccomment",   0x2 },
+   { "action*",      0x2 },
+   { "condition*",   0x2 },
+   { "settimer",     0x2 },
+   { "timeout",      0x2 },
+   { "stoptimer",    0x2 },
+   { "settimeout",   0x2 },
+   { "setstoptimer", 0x2 },
+};
 
-void exec_take(struct rt_msg * m)
+/**
+ * sheet and name of an instance of the current page, indexed by uid
+ */
+struct msc_sheet_inst
 {
-   if(msc_out)
-   {
-      write_line(msc_fd, "\\mess{take}{%x}{%x}\n", m->obj1, m->obj2);
-   }
-   if(sdl_out)
-   {
-   }
-   if(vcd_out)
-   {
-   }
-}
+   uint32_t     page;   /// msc_page_serial of the page, the entry is not valid for other pages
+   int          sheet;
+   const char * name;
+   int          name_len;
+   int          stub;   /// 1 if created by an instance of another sheet: it is declared on its sheet by a stub
+};
 
-void exec_give(struct rt_msg * m)
+/**
+ * a message received on a sheet without its sender. The found stub is drawn left levels later
+ */
+struct msc_found
 {
-   if(msc_out)
-   {
-      write_line(msc_fd, "\\mess{give}{%x}{%x}\n", m->obj1, m->obj2);
-   }
-   if(sdl_out)
-   {
-   }
-   if(vcd_out)
-   {
-   }
-}
+   int              left;
+   struct msc_line  line;
+};
 
-void exec_delmutex(struct rt_msg * m)
+/**
+ * text of the page being split, and state of the split
+ */
+static char                  * msc_sheet_text = NULL;
+static off_t                   msc_sheet_size = 0;
+static struct msc_sheet_inst * msc_sheet_map = NULL;
+static uint32_t                msc_sheet_map_size = 0;
+static struct msc_found      * msc_found_list = NULL;
+static int                     msc_found_count = 0;
+static int                     msc_found_size = 0;
+
+/**
+ * parse an msc line ending before end
+ */
+static void msc_line_parse(const char * p, const char * end, struct msc_line * l)
 {
-   if(msc_out)
-   {
-      write_line(msc_fd, "\\stop{%x}\n", m->obj2);
-      if(m->obj1 != m->obj2)
-         write_line(msc_fd, "\\mess{}{%x}{%x}\n", m->obj1, m->obj2);
-   }
-   if(sdl_out)
-   {
-   }
-   if(vcd_out)
+   l->cmd_len = 0;
+   l->lead    = NULL;
+   l->argc    = 0;
+
+   if((p == end) || (*p != '\\'))
+      return;
+
+   l->cmd = ++p;
+   while((p < end) && (((*p >= 'a') && (*p <= 'z')) || (*p == '*')))
+      p++;
+   l->cmd_len = p - l->cmd;
+
+   while((p < end) && ((*p == '{') || (*p == '[')))
    {
-      write_line(vcd_fd, "x^%x $end\n", m->obj2);
+      char close = (*p == '{') ? '}' : ']';
+      int depth = 0;
+      const char * start = ++p;
+
+      // texts may have their own braces
+      while((p < end) && (depth || (*p != close)))
+      {
+         if(*p == '{')
+            depth++;
+         else if(*p == '}')
+            depth--;
+         p++;
+      }
+
+      if(close == '}')
+      {
+         if(l->argc < MSC_LINE_ARGS)
+         {
+            l->arg[l->argc] = start;
+            l->len[l->argc] = p - start;
+            l->opt[l->argc] = NULL;
+         }
+         l->argc++;
+      }
+      else if(l->argc == 0)
+      {
+         l->lead = start;
+      }
+      else if(l->argc <= MSC_LINE_ARGS)
+      {
+         l->opt[l->argc - 1] = start;
+      }
+      p++;
    }
+   if(l->argc > MSC_LINE_ARGS)
+      l->argc = MSC_LINE_ARGS;
 }
 
-void exec_deltask(struct rt_msg * m)
+static inline int msc_line_is(const struct msc_line * l, const char * cmd)
 {
-   if(msc_out)
-   {
-      write_line(msc_fd, "\\stop{%x}\n", m->obj2);
-      if(m->obj1 != m->obj2)
-         write_line(msc_fd, "\\mess{kill}{%x}{%x}\n", m->obj1, m->obj2);
-   }
-   if(sdl_out)
-   {
-   }
-   if(vcd_out)
-   {
-      write_line(vcd_fd, "x^%x $end\n", m->obj2);
-   }
+   return (l->cmd_len == (int)string_len(cmd)) && (mem_cmp(l->cmd, cmd, l->cmd_len) == 0);
 }
 
-void exec_delobj(struct rt_msg * m)
+/**
+ * return the mask of the {} arguments of a line that are instance names
+ */
+static int msc_line_mask(const struct msc_line * l)
 {
-   if(msc_out)
-   {
-      write_line(msc_fd, "\\stop{%x}\n", m->obj2);
-      if(m->obj1 != m->obj2)
-         write_line(msc_fd, "\\mess{}{%x}{%x}\n", m->obj1, m->obj2);
-   }
-   if(sdl_out)
-   {
-   }
-   if(vcd_out)
+   int i;
+
+   for(i = 0; i < (int)(sizeof(msc_line_inst) / sizeof(msc_line_inst[0])); i++)
    {
-      write_line(vcd_fd, "x^%x $end\n", m->obj2);
+      if(msc_line_is(l, msc_line_inst[i].cmd))
+         return msc_line_inst[i].inst;
    }
+   return 0;
 }
 
-
-void exec_declbool(struct rt_msg * m)
+/**
+ * read the instance name of argument i of a line
+ * return -1 if the argument is not an instance name, 0 otherwise
+ */
+static int msc_line_uid(const struct msc_line * l, int i, uint32_t * uid)
 {
-   m->obj1->quantification = 1;
-   if(msc_out)
-   {
-   }
-   if(sdl_out)
-   {
-   }
-   if(vcd_def_out)
+   int k;
+
+   *uid = 0;
+   for(k = 0; k < l->len[i]; k++)
    {
-      write_line(vcd_def_fd, "$var wire 1 &%x %s $end\n", m->obj1, m->obj1->key);
+      char c = l->arg[i][k];
+      if((c >= '0') && (c <= '9'))
+         *uid = (*uid << 4) | (c - '0');
+      else if((c >= 'a') && (c <= 'f'))
+         *uid = (*uid << 4) | (c - 'a' + 10);
+      else
+         return -1;
    }
+   return (k > 0) ? 0 : -1;
 }
 
-void exec_declwire(struct rt_msg * m)
+/**
+ * return the entry of the instance named by argument i of a line, or NULL if it is not an instance of the page
+ */
+static struct msc_sheet_inst * msc_line_inst_of(const struct msc_line * l, int i)
 {
-   m->obj1->quantification = m->id2;
-   if(msc_out)
-   {
-   }
-   if(sdl_out)
-   {
-   }
-   if(vcd_def_out)
-   {
-      write_line(vcd_def_fd, "$var wire %d @%x %s $end\n", m->id2, m->obj1, m->obj1->key);
-   }
-}
+   uint32_t uid;
 
-void exec_declint(struct rt_msg * m)
-{
-   m->obj1->quantification = 0;
-   if(msc_out)
-   {
-   }
-   if(sdl_out)
-   {
-   }
-   if(vcd_def_out)
-   {
-      write_line(vcd_def_fd, "$var real 0 #%x %s $end\n", m->obj1, m->obj1->key);
-   }
+   if((i >= l->argc) || (msc_line_uid(l, i, &uid) < 0))
+      return NULL;
+
+   if((uid >= msc_sheet_map_size) || (msc_sheet_map[uid].page != msc_page_serial))
+      return NULL;
+   return &msc_sheet_map[uid];
 }
 
-void exec_declreal(struct rt_msg * m)
+/**
+ * add an instance of the page to a sheet
+ * return -1 if memory is missing, 0 otherwise
+ */
+static int msc_sheet_add(uint32_t uid, int sheet, const char * name, int name_len, int stub)
 {
-   m->obj1->quantification = 0;
-   if(msc_out)
-   {
-   }
-   if(sdl_out)
+   if(uid >= msc_sheet_map_size)
    {
+      uint32_t size = (rt_object_uid > uid) ? rt_object_uid : uid + 1;
+      struct msc_sheet_inst * map = (struct msc_sheet_inst *)heap_realloc(msc_sheet_map, size * sizeof(*map));
+
+      if(map == NULL)
+         return -1;
+      mem_set(map + msc_sheet_map_size, 0, (size - msc_sheet_map_size) * sizeof(*map));
+      msc_sheet_map      = map;
+      msc_sheet_map_size = size;
    }
-   if(vcd_def_out)
-   {
-      write_line(vcd_def_fd, "$var real 0 #%x %s $end\n", m->obj1, m->obj1->key);
-   }
+
+   msc_sheet_map[uid].page     = msc_page_serial;
+   msc_sheet_map[uid].sheet    = sheet;
+   msc_sheet_map[uid].name     = name;
+   msc_sheet_map[uid].name_len = name_len;
+   msc_sheet_map[uid].stub     = stub;
+   return 0;
 }
 
-void exec_declstring(struct rt_msg * m)
+/**
+ * draw the stub of a message between two sheets, on the sheet of its sender (lost) or of its receiver (found).
+ * Creations are drawn the same way, from the creator to the created instance.
+ */
+static void msc_sheet_stub(int fd, const struct msc_line * l, int sheet)
 {
-   m->obj1->quantification = 0;
-   if(msc_out)
-   {
-   }
-   if(sdl_out)
-   {
-   }
-   if(vcd_def_out)
-   {
-      write_line(vcd_def_fd, "$var string 0 $%x %s $end\n", m->obj1, m->obj1->key);
-   }
+   struct msc_sheet_inst * from = msc_line_inst_of(l, 1);
+   struct msc_sheet_inst * to   = msc_line_inst_of(l, 2);
+
+   if(from->sheet == sheet)
+      write_line(fd, "\\lost[%c]{%.*s}{%.*s}{%.*s}\n", (to->sheet > sheet) ? 'r' : 'l',
+                 l->len[0], l->arg[0], to->name_len, to->name, l->len[1], l->arg[1]);
+   else
+      write_line(fd, "\\found[%c]{%.*s}{%.*s}{%.*s}\n", (from->sheet > sheet) ? 'r' : 'l',
+                 l->len[0], l->arg[0], from->name_len, from->name, l->len[2], l->arg[2]);
 }
 
-void exec_declstate(struct rt_msg * m)
+/**
+ * draw the found stubs due in levels levels, moving down to them
+ */
+static void msc_sheet_levels(int fd, int sheet, int levels)
 {
-   m->obj1->quantification = 0;
-   if(msc_out)
-   {
-   }
-   if(sdl_out)
-   {
-   }
-   if(vcd_def_out)
+   int done = 0;
+   int i;
+   int j;
+
+   while(1)
    {
-      write_line(vcd_def_fd, "$var string 0 $%x %s $end\n", m->obj1, m->obj1->key);
+      int next = levels;
+
+      for(i = 0; i < msc_found_count; i++)
+      {
+         if(msc_found_list[i].left < next)
+            next = msc_found_list[i].left;
+      }
+
+      if(next > done)
+         write_line(fd, "\\nextlevel[%d]\n", next - done);
+      done = next;
+
+      // stubs of this level
+      for(i = 0, j = 0; i < msc_found_count; i++)
+      {
+         if(msc_found_list[i].left <= done)
+            msc_sheet_stub(fd, &msc_found_list[i].line, sheet);
+         else
+            msc_found_list[j++] = msc_found_list[i];
+      }
+      msc_found_count = j;
+
+      if(done >= levels)
+         break;
    }
+
+   for(i = 0; i < msc_found_count; i++)
+      msc_found_list[i].left -= levels;
 }
 
-void exec_setint(struct rt_msg * m)
+/**
+ * write one sheet of the page: the page header, the instances of the sheet, then the lines of the page body
+ * that involve them. Messages from or to other sheets are drawn as lost and found stubs, labelled with the name
+ * of the instance at the other end.
+ */
+static void msc_sheet_write(int fd, int sheet, off_t end)
 {
-   if(msc_out)
-   {
-   }
-   if(sdl_out)
+   struct msc_line l;
+   const char * p;
+   const char * eol;
+   int i;
+
+   sink_append(sink_get(fd), msc_sheet_text, msc_page_head);
+   for(i = 0; i < msc_seg_count; i++)
    {
+      if(msc_segs[i].used && (msc_sheet_map[msc_segs[i].uid].sheet == sheet))
+         sink_append(sink_get(fd), msc_sheet_text + msc_segs[i].off, msc_segs[i].len);
    }
-   if(vcd_out)
+
+   msc_found_count = 0;
+   for(p = msc_sheet_text + msc_page_body; p < msc_sheet_text + end; p = eol + 1)
    {
-      write_line(vcd_fd, "r%d #%x\n", m->id2, m->obj1);
+      struct msc_sheet_inst * inst;
+      int mask;
+      int in = 0;
+      int out = 0;
+
+      eol = mem_chr(p, '\n', msc_sheet_text + end - p);
+      if(eol == NULL)
+         eol = msc_sheet_text + end - 1;
+
+      msc_line_parse(p, eol, &l);
+      mask = msc_line_mask(&l);
+
+      // an instance created from another sheet is declared by the stub of its creation
+      if(msc_line_is(&l, "dummyinst") && (inst = msc_line_inst_of(&l, 0)) && inst->stub)
+         continue;
+
+      if(msc_line_is(&l, "nextlevel"))
+      {
+         msc_sheet_levels(fd, sheet, l.lead ? atoi(l.lead) : 1);
+         continue;
+      }
+
+      // messages received after the end of the page
+      if(msc_line_is(&l, "end"))
+      {
+         for(i = 0; i < msc_found_count; i++)
+            msc_sheet_stub(fd, &msc_found_list[i].line, sheet);
+         msc_found_count = 0;
+      }
+
+      for(i = 0; i < l.argc; i++)
+      {
+         if((mask & (1 << i)) && (inst = msc_line_inst_of(&l, i)))
+         {
+            if(inst->sheet == sheet)
+               in++;
+            else
+               out++;
+         }
+      }
+
+      if(out == 0)
+      {
+         sink_append(sink_get(fd), p, eol + 1 - p);
+      }
+      else if(in && msc_line_is(&l, "create"))
+      {
+         if(msc_line_inst_of(&l, 2)->sheet == sheet)
+            write_line(fd, "\\declinst{%.*s}{%.*s}{%.*s}\n", l.len[2], l.arg[2], l.len[3], l.arg[3], l.len[4], l.arg[4]);
+         msc_sheet_stub(fd, &l, sheet);
+      }
+      else if(in && (msc_line_is(&l, "mess") || msc_line_is(&l, "mess*")))
+      {
+         // an asynchronous message is received off levels later
+         int off = l.opt[2] ? atoi(l.opt[2]) : 0;
+
+         if((off > 0) && (msc_line_inst_of(&l, 2)->sheet == sheet))
+         {
+            if(msc_found_count == msc_found_size)
+            {
+               struct msc_found * list = (struct msc_found *)heap_realloc(msc_found_list,
+                                                   (msc_found_size + 16) * sizeof(struct msc_found));
+               if(list == NULL)
+                  continue;
+               msc_found_list  = list;
+               msc_found_size += 16;
+            }
+            msc_found_list[msc_found_count].left = off;
+            msc_found_list[msc_found_count].line = l;
+            msc_found_count++;
+         }
+         else
+         {
+            msc_sheet_stub(fd, &l, sheet);
+         }
+      }
    }
-   m->obj1->value = m->id2;
 }
 
-void exec_setreal(struct rt_msg * m)
+/**
+ * return the first sheet from *fill that has room for one more instance, and make it the sheet being filled
+ * return sheets if all sheets are full
+ */
+static int msc_sheet_fill(const int * count, int sheets, int * fill)
 {
-   if(msc_out)
-   {
-   }
-   if(sdl_out)
-   {
-   }
-   if(vcd_out)
-   {
-      write_line(vcd_fd, "r%d #%x\n", m->id2, m->obj1);
-   }
-   m->obj1->value = m->id2;
+   while((*fill < sheets) && (count[*fill] >= msc_page_max_instances))
+      (*fill)++;
+   return *fill;
 }
 
-void exec_setstring(struct rt_msg * m)
+/**
+ * split the page of the buffer file in sheets of up to msc_page_max_instances instances, in the order of their
+ * declaration. Instances created during the page are drawn on the sheet of their creator, unless it is full:
+ * they are then declared on the sheet being filled, with stubs for their creation.
+ */
+void msc_page_sheets(off_t end)
 {
-   if(msc_out)
+   struct msc_line l;
+   const char * p;
+   const char * eol;
+   int * count;
+   int fill = 0;
+   int sheets;
+   int sheet;
+   int i;
+
+   if(end > msc_sheet_size)
    {
+      char * text = (char *)heap_realloc(msc_sheet_text, end);
+      if(text == NULL)
+         return;
+      msc_sheet_text = text;
+      msc_sheet_size = end;
    }
-   if(sdl_out)
+   if(pread(msc_page_fd, msc_sheet_text, end, 0) != end)
    {
+      ERROR("Cannot read the msc page buffer\n");
+      return;
    }
-   if(vcd_out)
+
+   // the page has at most msc_page_instances instances, and all its sheets but the last one are full
+   sheets = msc_page_instances / msc_page_max_instances + 1;
+   count  = (int *)heap_alloc(sheets * sizeof(int));
+   if(count == NULL)
+      return;
+   mem_set(count, 0, sheets * sizeof(int));
+
+   // instances of the start of the page. Their segment starts with \declinst{uid}{above}{name}
+   for(i = 0; i < msc_seg_count; i++)
    {
-      char key[RT_CFG_MAX_TEXT_LEN];
-      generate_key(key, m->text);
-      write_line(vcd_fd, "s%s $%x\n", key, m->obj1);
+      if(msc_segs[i].used)
+      {
+         p = msc_sheet_text + msc_segs[i].off;
+         msc_line_parse(p, p + msc_segs[i].len, &l);
+         sheet = msc_sheet_fill(count, sheets, &fill);
+         if((sheet < sheets) &&
+            (msc_sheet_add(msc_segs[i].uid, sheet, (l.argc > 2) ? l.arg[2] : NULL, (l.argc > 2) ? l.len[2] : 0, 0) == 0))
+            count[sheet]++;
+      }
    }
-   string_cpy((char*)m->obj1->value, m->text);
-}
 
-void exec_setstate(struct rt_msg * m)
-{
-   if(msc_out)
+   // instances declared during the page, and instances created by other ones:
+   // \create{label}[t]{creator}[0.5]{uid}{above}{name}
+   for(p = msc_sheet_text + msc_page_body; p < msc_sheet_text + end; p = eol + 1)
    {
-      write_line(msc_fd, "\\condition*{%s}{%x}\n", m->text, m->obj1);
+      struct msc_sheet_inst * creator;
+      uint32_t uid;
+
+      eol = mem_chr(p, '\n', msc_sheet_text + end - p);
+      if(eol == NULL)
+         eol = msc_sheet_text + end - 1;
+
+      msc_line_parse(p, eol, &l);
+      if(msc_line_is(&l, "declinst") && (l.argc > 2) && (msc_line_uid(&l, 0, &uid) == 0) &&
+         (msc_sheet_fill(count, sheets, &fill) < sheets))
+      {
+         if(msc_sheet_add(uid, fill, l.arg[2], l.len[2], 0) == 0)
+            count[fill]++;
+      }
+      else if(msc_line_is(&l, "create") && (l.argc > 4) && (creator = msc_line_inst_of(&l, 1)) &&
+              (msc_line_uid(&l, 2, &uid) == 0))
+      {
+         // creator points in msc_sheet_map, that msc_sheet_add may move
+         int stub = (count[creator->sheet] >= msc_page_max_instances);
+
+         sheet = stub ? msc_sheet_fill(count, sheets, &fill) : creator->sheet;
+         if((sheet < sheets) && (msc_sheet_add(uid, sheet, l.arg[4], l.len[4], stub) == 0))
+            count[sheet]++;
+      }
    }
-   if(sdl_out)
+
+   // the page is as wide as its widest sheet
+   if((fill < sheets) && (count[fill] > 0))
+      fill++;
+   sheets = (fill > 0) ? fill : 1;
+   msc_page_instances = 0;
+   for(i = 0; i < sheets; i++)
    {
+      if(count[i] > msc_page_instances)
+         msc_page_instances = count[i];
    }
-   if(vcd_out)
+   heap_free(count);
+
+   for(i = 0; i < sheets; i++)
    {
-      char key[RT_CFG_MAX_TEXT_LEN];
-      generate_key(key, m->text);
-      write_line(vcd_fd, "s%s $%x\n", key, m->obj1);
+      if(i > 0)
+         write_line(msc_page_doc, "\\newpage\n");
+      msc_sheet_write(msc_page_doc, i, end);
    }
-   string_cpy((char*)m->obj1->value, m->text);
 }
 
-void exec_creategrp(struct rt_msg * m)
+/**
+ * copy the page from the buffer file to the document: the page header, the instances used by the page, then the
+ * page body. Pages showing more than msc_page_max_instances instances are split in sheets.
+ * Next msc lines are written in the document.
+ */
+void msc_page_release(void)
 {
-   if(msc_out)
+   off_t end = sink_tell(msc_fd);
+   int shown = 0;
+   int i;
+
+   sink_flush(sink_get(msc_fd));
+
+   for(i = 0; i < msc_seg_count; i++)
    {
+      if(msc_cull && !msc_segs[i].used)
+         msc_page_instances--;
+      else
+         msc_segs[i].used = ++shown;
    }
-   if(sdl_out)
+
+   if(msc_page_max_instances && (msc_page_instances > msc_page_max_instances))
    {
+      msc_page_sheets(end);
    }
-   if(vcd_def_out)
+   else
    {
-      write_line(vcd_def_fd, "$scope module %s $end\n", m->obj1->key);
+      sink_copy(msc_page_doc, msc_page_fd, 0, msc_page_head);
+      for(i = 0; i < msc_seg_count; i++)
+      {
+         if(msc_segs[i].used)
+            sink_copy(msc_page_doc, msc_page_fd, msc_segs[i].off, msc_segs[i].len);
+      }
+      sink_copy(msc_page_doc, msc_page_fd, msc_page_body, end - msc_page_body);
    }
+
+   msc_fd = msc_page_doc;
+   if(ftruncate(msc_page_fd, 0) < 0)
+      ERROR("Cannot reset the msc page buffer\n");
+   lseek(msc_page_fd, 0, SEEK_SET);
 }
 
-void exec_delgrp(struct rt_msg * m)
+/**
+ * Redraw the living instances following the natural object group order, with their status, at the start of a page
+ */
+void msc_redraw(void)
 {
-   if(msc_out)
-   {
-   }
-   if(sdl_out)
-   {
-   }
-   if(vcd_def_out)
+   struct rt_msg m;
+   struct rt_object * k;
+   object_status_t status;
+   off_t off;
+   int i;
+
+   // values that we don't care
+   m.time = 0;
+   m.id2 = 0;
+   m.msc_level = 0;
+   m.vcd_level = 0;
+   m.group = NULL;
+   m.obj2 = NULL;
+
+   rt_view_update();
+   for(i = 0; i < msc_view.count; i++)
    {
-      write_line(vcd_def_fd, "$upscope $end\n");
+      k = msc_view.obj[i];
+
+      /**
+       * redraw this object instance
+       */
+      m.cmd  = msc_view.cmd[i];
+      m.id1  = k->oid;
+      m.obj1 = k;
+      m.txt  = k->name;
+      m.text = text_str(k->name);
+      off    = msc_buffered ? sink_tell(msc_fd) : 0;
+      exec_cmd(&m);
+
+      /**
+       * restore object status (when msc page breaks, all values are drawed as defaut,
+       * RT_OBJECT_READY)
+       */
+      status    = k->status;
+      k->status = RT_OBJECT_INIT;
+      switch (status)
+      {
+         case RT_OBJECT_PREEMPT:
+            m.cmd = RT_DEF_CMD_PREEMPT;
+            break;
+         case RT_OBJECT_RUN:
+            m.cmd = RT_DEF_CMD_RUN;
+            break;
+         case RT_OBJECT_WAIT:
+            m.cmd = RT_DEF_CMD_WAIT;
+            break;
+         case RT_OBJECT_READY:
+            m.cmd = RT_DEF_CMD_READY;
+            break;
+         default:
+            // other objects are not not msc
+            m.cmd = RT_DEF_CMD_MAX;
+            break;
+      }
+      if(m.cmd != RT_DEF_CMD_MAX)
+         exec_cmd(&m);
+
+      if(msc_buffered)
+         msc_seg_add(k, off);
    }
 }
 
-void exec_activate(struct rt_msg * m)
+/**
+ * write a mark at the left of the current level, at its top (tl) or at its bottom (bl)
+ */
+void msc_mark(int fd, const char * pos, rt_time_t time)
 {
-   if(msc_out)
-   {
-      if(m->obj1->status != RT_OBJECT_RUN)
-         write_line(msc_fd, "\\regionstart{activation}{%x}\n", m->obj1);
-   }
-   if(sdl_out)
-   {
-   }
-   if(vcd_out)
+   char str[32];
+
+   switch(msc_mark_disp)
    {
-      if(m->obj1->status != RT_OBJECT_RUN)
-         write_line(vcd_fd, "1^%x $end\n", m->obj1);
+      case MSC_MARK_DISPLAY_BOTH:
+         string_printf(str, "%d : %d", time, msc_level);
+         break;
+      case MSC_MARK_DISPLAY_REALTIME:
+         string_printf(str, "%d", time);
+         break;
+      case MSC_MARK_DISPLAY_LEVEL:
+         string_printf(str, "%d", msc_level);
+         break;
+      default:
+         return;
    }
-   m->obj1->status = RT_OBJECT_RUN;
+   write_line(fd, "\\mscmark[%s]{%s}{envleft}\n", pos, str);
+   svg_mark(pos[0] == 't', str);
 }
 
-void exec_acquire(struct rt_msg * m)
+/**
+ * write the mark of a collapsed idle span of gap ticks, at the top of the current level
+ */
+void msc_gap_mark(int fd, rt_time_t gap)
 {
-   if(msc_out)
-   {
-      write_line(msc_fd, "\\mess*{acquire}{%x}{%x}\n", m->obj1, m->obj2);
+   char str[32];
 
-      if(m->obj1->status != RT_OBJECT_RUN)
-         write_line(msc_fd, "\\regionstart{activation}{%x}\n", m->obj1);
+   string_printf(str, "gap %d", gap);
+   write_line(fd, "\\mscmark[tl]{%s}{envleft}\n", str);
+   svg_mark(1, str);
+}
 
-      if(m->obj2->status != RT_OBJECT_READY)
-         write_line(msc_fd, "\\regionend{%x}\n", m->obj2);
-   }
-   if(sdl_out)
-   {
-   }
-   if(vcd_out)
-   {
-      if(m->obj1->status != RT_OBJECT_RUN)
-         write_line(vcd_fd, "1^%x\n", m->obj1);
+/**
+ * maximum number of runs of repeated msc events followed at once
+ */
+#define MSC_AGGR_RUNS 16
 
-      if(m->obj2->status != RT_OBJECT_READY)
-         write_line(vcd_fd, "0^%x\n", m->obj2);
-   }
-   m->obj1->status = RT_OBJECT_RUN;
-   m->obj2->status = RT_OBJECT_READY;
-}
+/**
+ * run of identical msc events. Its first event is drawn, the following ones are only counted
+ */
+struct msc_run
+{
+   int                count;      /// number of events of the run, 0 if the entry is free
+   rt_cmd_t           cmd;
+   int                fid;
+   object_id_t        id1;
+   object_id_t        id2;
+   struct rt_text   * txt;        /// text of the events, one reference is held by the run
+   rt_time_t          first;      /// time of the first event
+   rt_time_t          last;       /// time of the last event
+   struct rt_object * obj1;       /// instance annotated with the count
+   struct rt_object * obj2;
+};
 
-void exec_declevent(struct rt_msg * m)
+static struct msc_run msc_runs[MSC_AGGR_RUNS];
+
+/**
+ * number of drawn messages and timers whose end is not processed yet. Aggregated events keep their levels
+ * meanwhile, so that the arrows keep their length
+ */
+static int msc_in_flight = 0;
+
+/**
+ * 1 if a msc event may be aggregated with identical ones
+ */
+static inline int msc_aggr_candidate(struct rt_msg * m)
 {
-   m->obj1->quantification = 1;
-   if(msc_out)
-   {
-   }
-   if(vcd_def_out)
-   {
-      write_line(vcd_def_fd, "$var event 1 !%x %s $end\n", m->obj1, m->obj1->key);
-   }
-   if(sdl_out)
+   switch(m->cmd)
    {
+      case RT_DEF_CMD_SENDMSG:
+      case RT_DEF_CMD_SETSTATE:
+      case RT_DEF_CMD_ACTION:
+         return 1;
+      case RT_DEF_CMD_RECVMSG:
+         return !m->corr;
+      default:
+         return 0;
    }
 }
 
-void exec_decltime(struct rt_msg * m)
+/**
+ * end a run, with a comment giving the count and the time range of its events if some were aggregated
+ */
+static void msc_run_close(struct msc_run * r)
 {
-   m->obj1->quantification = m->id2;
-   if(msc_out)
-   {
-   }
-   if(vcd_def_out)
-   {
-      write_line(vcd_def_fd, "$var time %d @%x %s $end\n", m->id2, m->obj1, m->obj1->key);
-   }
-   if(sdl_out)
+   char str[64];
+
+   if(msc_out && (r->count > 1))
    {
+      string_printf(str, "x%d @%d..%d", r->count, r->first, r->last);
+      msc_use(r->obj1);
+      write_line(msc_fd, "\\msccomment[r]{%s}{%x}\n", str, r->obj1->uid);
+      svg_comment(str, r->obj1);
    }
+   text_put(r->txt);
+   r->count = 0;
 }
 
-void exec_declparam(struct rt_msg * m)
+/**
+ * end all runs, or the runs of an instance if k is not NULL
+ */
+void msc_aggr_close(struct rt_object * k)
 {
-   m->obj1->quantification = m->id2;
-   if(msc_out)
-   {
-   }
-   if(vcd_def_out)
-   {
-      write_line(vcd_def_fd, "$var parameter %d @%x %s $end\n", m->id2, m->obj1, m->obj1->key);
-   }
-   if(sdl_out)
+   int i;
+
+   for(i = 0; i < MSC_AGGR_RUNS; i++)
    {
+      if(msc_runs[i].count && ((k == NULL) || (msc_runs[i].obj1 == k) || (msc_runs[i].obj2 == k)))
+         msc_run_close(&msc_runs[i]);
    }
 }
 
-void exec_declreg(struct rt_msg * m)
+/**
+ * return 1 if a drawn event belongs to a run: it repeats the run, or it is the correlated reception of the
+ * message drawn at the head of a run of sends
+ */
+static int msc_run_owns(struct msc_run * r, struct rt_msg * m)
 {
-   m->obj1->quantification = m->id2;
-   if(msc_out)
-   {
-   }
-   if(vcd_def_out)
-   {
-      write_line(vcd_def_fd, "$var reg %d @%x %s $end\n", m->id2, m->obj1, m->obj1->key);
-   }
-   if(sdl_out)
-   {
-   }
+   if((r->cmd == m->cmd) && (r->fid == m->fid) && (r->id1 == m->id1) && (r->id2 == m->id2) && (r->txt == m->txt))
+      return 1;
+
+   return (r->cmd == RT_DEF_CMD_SENDMSG) && (m->cmd == RT_DEF_CMD_RECVMSG) && m->corr &&
+          (r->obj1 == m->obj1) && (r->obj2 == m->obj2) && (r->txt == m->txt);
 }
 
-void exec_setevent(struct rt_msg * m)
+/**
+ * end the runs of the instances of a drawn event, except the runs it belongs to
+ */
+void msc_aggr_end(struct rt_msg * m)
 {
-   if(msc_out)
-   {
-   }
-   if(vcd_out)
-   {
-      write_line(vcd_fd, "%d!%x\n", m->id2, m->obj1);
-   }
-   if(sdl_out)
+   struct msc_run * r;
+   int i;
+
+   for(i = 0; i < MSC_AGGR_RUNS; i++)
    {
+      r = &msc_runs[i];
+      if(r->count && ((m->obj1 && ((r->obj1 == m->obj1) || (r->obj2 == m->obj1))) ||
+                      (m->obj2 && ((r->obj1 == m->obj2) || (r->obj2 == m->obj2)))) &&
+         !msc_run_owns(r, m))
+         msc_run_close(r);
    }
-   m->obj1->value = m->id2;
 }
 
-void exec_setparam(struct rt_msg * m)
+/**
+ * end the runs older than msc_aggregate ticks, then flag m as aggregated if it repeats a run.
+ * The queued message correlated with an aggregated one is flagged too, so that it is not drawn.
+ */
+void msc_aggr_check(struct rt_msg * m)
 {
-   if(msc_out)
-   {
-   }
-   if(vcd_out)
-   {
-      char bin[32];
-      to_binary(m->id2, bin);
-      write_line(vcd_fd, "b%s @%x\n", bin, m->obj1);
-   }
-   if(sdl_out)
+   struct msc_run * r;
+   int i;
+
+   for(i = 0; i < MSC_AGGR_RUNS; i++)
    {
+      r = &msc_runs[i];
+      if(!r->count)
+         continue;
+      if(m->time - r->last > (rt_time_t)msc_aggregate)
+      {
+         msc_run_close(r);
+         continue;
+      }
+      if((r->cmd == m->cmd) && (r->fid == m->fid) && (r->id1 == m->id1) && (r->id2 == m->id2) && (r->txt == m->txt))
+      {
+         r->count++;
+         r->last = m->time;
+         m->aggr = 1;
+         if(m->corr && m->corr_event)
+            m->corr_event->flags |= RT_EVENT_AGGR;
+         msc_aggr_count++;
+         return;
+      }
    }
-   m->obj1->value = m->id2;
 }
 
-void exec_setreg(struct rt_msg * m)
+/**
+ * after a drawn msc event: count the messages in flight, and start a run with m if it may be repeated
+ */
+void msc_aggr_update(struct rt_msg * m)
 {
-   if(msc_out)
-   {
-   }
-   if(vcd_out)
+   struct msc_run * r = NULL;
+   int i;
+
+   if(m->corr)
    {
-      char bin[32];
-      to_binary(m->id2, bin);
-      write_line(vcd_fd, "b%s @%x\n", bin, m->obj1);
+      if((m->cmd == RT_DEF_CMD_SENDMSG) || (m->cmd == RT_DEF_CMD_SETTIMER))
+         msc_in_flight++;
+      else if(msc_in_flight > 0)
+         msc_in_flight--;
    }
-   if(sdl_out)
+
+   if(!msc_out || !msc_aggr_candidate(m))
+      return;
+
+   // take a free run, or end the least recent one
+   for(i = 0; i < MSC_AGGR_RUNS; i++)
    {
-   }
-   m->obj1->value = m->id2;
+      if(!msc_runs[i].count)
+      {
+         r = &msc_runs[i];
+         break;
+      }
+      if((r == NULL) || (msc_runs[i].last < r->last))
+         r = &msc_runs[i];
+   }
+   if(r->count)
+      msc_run_close(r);
+
+   r->count = 1;
+   r->cmd   = m->cmd;
+   r->fid   = m->fid;
+   r->id1   = m->id1;
+   r->id2   = m->id2;
+   r->txt   = m->txt;
+   r->first = m->time;
+   r->last  = m->time;
+   r->obj1  = m->obj1;
+   r->obj2  = m->obj2;
+   text_hold(r->txt);
 }
 
-void exec_settime(struct rt_msg * m)
+/**
+ * end current msc diagram
+ */
+int msc_dump_start(int fd, char * title, rt_time_t time)
 {
-   if(msc_out)
-   {
-   }
-   if(vcd_out)
-   {
-      char bin[32];
-      to_binary(m->id2, bin);
-      write_line(vcd_fd, "b%s @%x\n", bin, m->obj1);
-   }
-   if(sdl_out)
+   // with a page buffer, the whole page is written in it
+   if(msc_buffered)
    {
+      msc_page_capture();
+      fd = msc_fd;
    }
-   m->obj1->value = m->id2;
+
+   write_line(fd, "\\begin{msc}{%s}\n", title);
+   svg_page_start(title);
+   write_line(fd, "\\setlength{\\topheaddist}{%dmm}\n",      msc_level_height);
+   write_line(fd, "\\setlength{\\levelheight}{%dmm}\n",      msc_level_height);
+   write_line(fd, "\\setlength{\\bottomfootdist}{%dmm}\n",   msc_level_height);
+   write_line(fd, "\\setlength{\\bottomfootdist}{%dmm}\n",   msc_level_height);
+   write_line(fd, "\\setlength{\\actionheight}{%dmm}\n",     msc_box_height);
+   write_line(fd, "\\setlength{\\conditionheight}{%dmm}\n",  msc_box_height);
+   write_line(fd, "\\setlength{\\instheadheight}{%dmm}\n",   msc_box_height);
+   write_line(fd, "\\setlength{\\firstlevelheight}{%dmm}\n", msc_box_height);
+   write_line(fd, "\\setlength{\\lastlevelheight}{%dmm}\n",  msc_box_height);
+   write_line(fd, "\\setlength{\\instdist}{%dmm}\n",         msc_inst_dist);
+   write_line(fd, "\\setlength{\\envinstdist}{\\instdist}\n");
+   write_line(fd, "\\setlength{\\instfootheight}{%dmm}\n",   3);
+   write_line(fd, "\\setlength{\\markdist}{%dmm}\n",         0);
+
+   msc_page_instances = 0;
+
+   if(msc_buffered)
+      msc_page_head = sink_tell(msc_fd);
+
+   msc_redraw();
+
+   if(msc_buffered)
+      msc_page_body = sink_tell(msc_fd);
+
+   if(msc_mark_grain == MSC_MARK_GRANULARITY_PAGE)
+      msc_mark(msc_fd, "bl", time);
+
+   return 0;
 }
 
-void exec_setbool(struct rt_msg * m)
+/**
+ * copy len bytes of in, starting at offset off, at the current offset of out. The copy is done by the kernel.
+ * return -1 if the copy failed, 0 otherwise
+ */
+int file_copy(int out, int in, off_t off, off_t len)
 {
-   if(msc_out)
-   {
-   }
-   if(vcd_out)
-   {
-      write_line(vcd_fd, "%d&%x\n", m->id2, m->obj1);
-   }
-   if(sdl_out)
+   ssize_t n;
+
+   while(len > 0)
    {
+      n = copy_file_range(in, &off, out, NULL, len, 0);
+
+      // copy_file_range is not supported by older kernels, nor between all file systems
+      if(n <= 0)
+         n = sendfile(out, in, &off, len);
+      if(n <= 0)
+         return -1;
+      len -= n;
    }
-   m->obj1->value = m->id2;
+   return 0;
 }
 
-void exec_setwire(struct rt_msg * m)
+/**
+ * create a unique temporary file next to a file, named <file>.XXXXXX
+ * return its file descriptor, or -1
+ */
+int temp_file(const char * file, char * path)
 {
-   if(msc_out)
-   {
-   }
-   if(vcd_out)
-   {
-      char bin[32];
-      to_binary(m->id2, bin);
-      write_line(vcd_fd, "b%s @%x\n", bin, m->obj1);
-   }
-   if(sdl_out)
-   {
-   }
-   m->obj1->value = m->id2;
+   string_printf(path, "%s.XXXXXX", file);
+   return mkstemp(path);
 }
 
-void exec_startdump(struct rt_msg * m)
+/**
+ * Assemble the vcd file at exit: copy definitions (vcd_def_fd) in the space reserved before value changes in vcd_fd.
+ * When definitions are larger than the reserved space, or when value changes are so small that the blank space would
+ * dominate the file, definitions and value changes are copied in a new file, that replaces vcd_doc.
+ * return -1 if the vcd file cannot be written, 0 otherwise
+ */
+int vcd_assemble(const char * vcd_doc)
 {
-   if(msc_fd > 0)
-   {
-      if(msc_out == 0)
-      {
-         msc_out   = 1;
-         msc_page  = msc_get_time(m);
-         msc_level = msc_page;
-         msc_dump_start(msc_fd, "msc", m->time);
-      }
-      else
-      {
-         ERROR("msc dumping already activated\n");
-      }
-   }
-   if(vcd_fd > 0)
-   {
-      if(vcd_out == 0)
-      {
-         vcd_out   = 1;
-         vcd_level = vcd_get_time(m);
-         vcd_dump_start(vcd_fd, m->time);
-      }
-      else
+   char path[RT_CFG_MAX_TEXT_LEN + 8];
+   char pad[4096];
+   struct stat st;
+   off_t def_len = lseek(vcd_def_fd, 0, SEEK_END);
+   off_t sim_len = lseek(vcd_fd, 0, SEEK_END) - vcd_header;
+   off_t off;
+   int n, fd;
+
+   if(sim_len < 0)
+      sim_len = 0;
+
+   if((def_len <= vcd_header) && (sim_len >= vcd_header))
+   {
+      // fill the space left between definitions and value changes with blanks
+      lseek(vcd_fd, 0, SEEK_SET);
+      if(file_copy(vcd_fd, vcd_def_fd, 0, def_len) < 0)
+         return -1;
+
+      mem_set(pad, ' ', sizeof(pad));
+      for(off = def_len; off < vcd_header; off += n)
       {
-         ERROR("vcd dumping already activated\n");
+         n = (vcd_header - off < (off_t)sizeof(pad)) ? vcd_header - off : sizeof(pad);
+         if(off + n == vcd_header)
+            pad[n - 1] = '\n';
+         if(pwrite(vcd_fd, pad, n, off) != n)
+            return -1;
       }
- 
+      return 0;
    }
-   if(sdl_fd > 0)
+
+   INFO("copy %ld bytes of vcd definitions and %ld bytes of value changes\n", (long)def_len, (long)sim_len);
+   fd = temp_file(vcd_doc, path);
+   if(fd < 0)
+      return -1;
+
+   // keep the permissions of vcd_doc, not the ones of a temporary file
+   if((fstat(vcd_fd, &st) < 0) ||
+      (fchmod(fd, st.st_mode & 07777) < 0) ||
+      (file_copy(fd, vcd_def_fd, 0, def_len) < 0) ||
+      (file_copy(fd, vcd_fd, vcd_header, sim_len) < 0) ||
+      (rename(path, vcd_doc) < 0))
    {
+      close(fd);
+      unlink(path);
+      return -1;
    }
+   close(fd);
+   return 0;
 }
 
-void exec_stopdump(struct rt_msg * m)
+/**
+ * An iterator function for vcd_start_dump function.
+ * Redraw an object following the natural object group order.
+ */
+int vcd_define_symbols(struct rt_object * k, int exit, void * info)
 {
-   if(msc_fd > 0)
-   {
-      if(msc_out)
-      {
-         msc_dump_stop(msc_fd, m->time);
-         msc_out = 0;
-      }
-      else
-      {
-         ERROR("msc dumping already deactivated\n");
-      }
-   }
-   if(vcd_fd > 0)
-   {
-      if(vcd_out)
-      {
-         vcd_level = vcd_get_time(m);
-         write_line(vcd_fd, "#%d\n", vcd_level);
-         vcd_out = 0;
-      }
-      else
-      {
-         ERROR("vcd dumping already deactivated\n");
-      }
-   }
-   if(sdl_fd > 0)
-   {
-   }
-}
+   struct rt_msg m;
 
-void exec_delvar(struct rt_msg * m)
-{
-   if(msc_out)
+   rt_cmd_t cmd;
+
+   // values that we don't care
+   m.time = 0;
+   m.id2 = 0;
+   m.msc_level = 0;
+   m.vcd_level = 0;
+   m.obj1 = NULL;
+   m.obj2 = NULL;
+
+   // if the declaration of the vcd symbol is already in the vcd_def file, do not redeclare it
+   if(exit)
    {
+      if(k->type == RT_GROUP)
+         cmd = RT_DEF_CMD_DELGRP;
+      else
+         return 0;
    }
-   if(vcd_out)
+   else
    {
-      switch(m->obj1->type)
+      switch (k->type)
       {
-         case RT_STRING:
-            write_line(vcd_fd, "sUNDEF $%x\n", m->obj1);
-            break;
-         case RT_INT:
          case RT_REAL:
-            write_line(vcd_fd, "rnan #%x\n", m->obj1);
+            cmd = RT_DEF_CMD_DECLREAL;
             break;
-         case RT_BOOL:
-            write_line(vcd_fd, "x&%x\n", m->obj1);
+         case RT_REG:
+            cmd = RT_DEF_CMD_DECLREG;
             break;
          case RT_PARAM:
+            cmd = RT_DEF_CMD_DECLPARAM;
+            break;
          case RT_WIRE:
+            cmd = RT_DEF_CMD_DECLWIRE;
+            break;
+         case RT_BOOL:
+            cmd = RT_DEF_CMD_DECLBOOL;
+            break;
          case RT_TIME:
-         case RT_REG:
-            write_line(vcd_fd, "bx @%x\n", m->obj1);
+            cmd = RT_DEF_CMD_DECLTIME;
             break;
-         default:
+         case RT_EVENT:
+            cmd = RT_DEF_CMD_DECLEVENT;
+            break;
+         case RT_STRING:
+            cmd = RT_DEF_CMD_DECLSTRING;
+            break;
+         case RT_INT:
+            cmd = RT_DEF_CMD_DECLINT;
+            break;
+         case RT_TASK:
+            cmd = RT_DEF_CMD_DECLTASK;
+            break;
+         case RT_OBJECT:
+            cmd = RT_DEF_CMD_DECLOBJ;
+            break;
+         case RT_MUTEX:
+            cmd = RT_DEF_CMD_DECLMUTEX;
+            break;
+         case RT_GROUP:
+            cmd = RT_DEF_CMD_CREATGRP;
             break;
+         default:
+            return 0;
       }
    }
-   if(sdl_out)
-   {
-   }
+
+   m.id1 = k->oid;
+   m.id2 = k->quantification;
+   m.cmd = cmd;
+   m.txt  = k->name;
+   m.text = text_str(k->name);
+   m.obj1 = k;
+   exec_cmd(&m);
+
+   return 0;
 }
 
-void exec_setglobal(struct rt_msg * m)
+/**
+ * Write vcd definitions
+ */
+void vcd_write_definitions()
 {
-   m->obj1->global = 1;
-   m->obj1->global_id = m->id2;
+   int saved_msc = msc_out;
+   int saved_sdl = sdl_out;
 
-   if(msc_out)
-   {
-   }
-   if(vcd_out)
-   {
-   }
-   if(sdl_out)
-   {
-   }
+   msc_out = 0;
+   sdl_out = 0;
+
+   INFO("end of vcd definition section\n");
+   vcd_def_out = 1;
+   for_each_object(&top, vcd_define_symbols, NULL);
+   vcd_def_out = 0;
+
+   msc_out = saved_msc;
+   sdl_out = saved_sdl;
 }
 
 /**
- * Indicate all representations for a command
+ * Write the current values of the vcd variables, zombies included, following the natural object group order
  */
-int classify_cmd(rt_cmd_t cmd)
+void vcd_reload_values(void)
 {
-   int class = 0;
-   switch(cmd)
+   struct rt_msg m;
+   struct rt_object * k;
+   int i;
+
+   // values that we don't care
+   m.time = 0;
+   m.id2 = 0;
+   m.msc_level = 0;
+   m.vcd_level = 0;
+   m.obj2 = NULL;
+
+   rt_view_update();
+   for(i = 0; i < vcd_view.count; i++)
    {
-      case RT_DEF_CMD_SETEVENT:
-      case RT_DEF_CMD_SETPARAM:
-      case RT_DEF_CMD_SETREG:
-      case RT_DEF_CMD_SETTIME:
-      case RT_DEF_CMD_SETBOOL:
-      case RT_DEF_CMD_DECLBOOL:
-      case RT_DEF_CMD_DECLWIRE:
-      case RT_DEF_CMD_DECLINT:
-      case RT_DEF_CMD_DECLREAL:
-      case RT_DEF_CMD_DECLSTRING:
-      case RT_DEF_CMD_DECLPARAM:
-      case RT_DEF_CMD_DECLREG:
-      case RT_DEF_CMD_DECLTIME:
-      case RT_DEF_CMD_DECLEVENT:
-      case RT_DEF_CMD_SETINT:
-      case RT_DEF_CMD_SETREAL:
-      case RT_DEF_CMD_SETSTRING:
-      case RT_DEF_CMD_SETWIRE:
-      case RT_DEF_CMD_DELVAR:
-         class = RT_VCD;
-         break;
-      case RT_DEF_CMD_SETSTATE:
-      case RT_DEF_CMD_DECLTASK:
-      case RT_DEF_CMD_DECLMUTEX:
-      case RT_DEF_CMD_DECLOBJ:
-      case RT_DEF_CMD_WAIT:
-      case RT_DEF_CMD_SWITCH:
-      case RT_DEF_CMD_READY:
-      case RT_DEF_CMD_PREEMPT:
-      case RT_DEF_CMD_CREATGRP:
-      case RT_DEF_CMD_DELGRP:
-      case RT_DEF_CMD_RUN:
-      case RT_DEF_CMD_CREATTASK:
-      case RT_DEF_CMD_CREATOBJ:
-      case RT_DEF_CMD_CREATMUTEX:
-      case RT_DEF_CMD_CALL:
-      case RT_DEF_CMD_RETURN:
-      case RT_DEF_CMD_DELMUTEX:
-      case RT_DEF_CMD_DELTASK:
-      case RT_DEF_CMD_DELOBJ:
-      case RT_DEF_CMD_ACQUIRE:
-      case RT_DEF_CMD_SETGLOBAL:
-         class = RT_MSC|RT_VCD;
-         break;
-      case RT_DEF_CMD_COMMENT:
-      case RT_DEF_CMD_SENDMSG:
-      case RT_DEF_CMD_RECVMSG:
-      case RT_DEF_CMD_ACTION:
-      case RT_DEF_CMD_SETTIMER:
-      case RT_DEF_CMD_TIMEOUT:
-      case RT_DEF_CMD_STOPTIMER:
-      case RT_DEF_CMD_TAKE:
-      case RT_DEF_CMD_GIVE:
-         class = RT_MSC;
-         break;
+      k = vcd_view.obj[i];
+
+      m.id1  = k->oid;
+      m.cmd  = vcd_view.cmd[i];
+      m.obj1 = k;
+
+      switch (k->type)
+      {
+         case RT_STRING:
+         case RT_TASK:
+         case RT_OBJECT:
+            m.id2  = 0;
+            m.txt  = (struct rt_text *)k->value;
+            m.text = text_str(m.txt);
+            break;
+         default:
+            m.id2  = k->value;
+            m.txt  = NULL;
+            m.text = "";
+            break;
+      }
+      exec_cmd(&m);
+
+      /**
+       * restore object status (when msc page breaks, all values are drawed as defaut,
+       * RT_OBJECT_READY)
+       */
+      if (k->type == RT_TASK || k->type == RT_OBJECT)
+      {
+         object_status_t status = k->status;
+
+         k->status = RT_OBJECT_INIT; // force redraw of the status
+
+         switch (status)
+         {
+            case RT_OBJECT_PREEMPT:
+               m.cmd = RT_DEF_CMD_PREEMPT;
+               break;
+            case RT_OBJECT_RUN:
+               m.cmd = RT_DEF_CMD_RUN;
+               break;
+            case RT_OBJECT_WAIT:
+               m.cmd = RT_DEF_CMD_WAIT;
+               break;
+            case RT_OBJECT_READY:
+               m.cmd = RT_DEF_CMD_READY;
+               break;
+            case RT_OBJECT_INIT:
+               continue;
+         }
+
+         exec_cmd(&m);
+      }
    }
+}
 
-   return class;
+/**
+ * at the time we reenable the logs, all values must be updated with the internal values stored while the logs
+ * where disabled.
+ */
+int vcd_dump_start(int fd, rt_time_t time)
+{
+   int saved_msc = msc_out;
+   int saved_sdl = sdl_out;
+
+   msc_out = 0;
+   sdl_out = 0;
+
+   // indicate the new time where dump restart
+   if(vcd_level > 0)
+      write_time(vcd_fd, vcd_level);
+
+   // restore current values
+   vcd_reload_values();
+
+   msc_out = saved_msc;
+   sdl_out = saved_sdl;
+
+   return 0;
 }
 
 /**
- * extract from a command what we need to do (new, check or del) on objects for id1 and i2
+ * end current msc diagram
  */
-void get_cmd_syntax(struct rt_msg * m,
-                    int           * chk_group,
-                    int           * chk_param1,
-                    int           * chk_param2,
-                    int           * new_param1,
-                    int           * new_param2,
-                    int           * del_param1,
-                    int           * del_param2)
+int msc_dump_stop(int fd, rt_time_t time)
 {
-   *chk_param1 = RT_NONE;
-   *chk_group  = RT_NONE;
-   *chk_param2 = RT_NONE;
-   *new_param1 = RT_NONE;
-   *new_param2 = RT_NONE;
-   *del_param1 = RT_NONE;
-   *del_param2 = RT_NONE;
+   // runs do not cross pages
+   if(msc_aggregate)
+      msc_aggr_close(NULL);
 
-   switch(m->cmd)
+   if(msc_mark_grain == MSC_MARK_GRANULARITY_PAGE)
+      msc_mark(fd, "tl", time);
+
+   write_line(fd, "\\end{msc}\n");
+   svg_page_end();
+
+   // the addresses of compacted zombies may be reused on the next page
+   flush_graveyard();
+
+   if(msc_buffered)
+      msc_page_release();
+
+   if(msc_page_instances > msc_max_instances)
+      msc_max_instances = msc_page_instances;
+   if(msc_page_instances > msc_unit_instances)
+      msc_unit_instances = msc_page_instances;
+   msc_unit_pages++;
+
+   return 0;
+}
+
+
+/**
+ * end current document
+ */
+int msc_end_doc(int fd)
+{
+   write_line(fd, "\\end{document}\n");
+   return 0;
+}
+
+/**
+ * paper size, in mm, of msc pages showing up to instances instances
+ */
+static inline int msc_paper_width(int instances)
+{
+   return (instances + 2 /*env left + env right */ - 1) * msc_inst_dist + 20 /* left + right margin */;
+}
+
+static inline int msc_paper_height(void)
+{
+   return (msc_page_max_levels + 7) * msc_level_height;
+}
+
+/**
+ * a worker process compiling an msc unit, one step after the other
+ */
+struct msc_job
+{
+   pid_t    pid;   /// process of the current step, 0 if the slot is free
+   int      unit;  /// compiled unit
+   int      step;  /// MSC_JOB_xxx
+   uint64_t hash;  /// hash of the unit, to store its pdf in the cache, 0 if none
+};
+
+enum msc_job_step
+{
+   MSC_JOB_LATEX  = 0,   /// latex compiles <msc_base>_<unit>.tex to a dvi file
+   MSC_JOB_DVIPDF = 1,   /// dvipdf converts it to <msc_base>_<unit>.pdf
+};
+
+/**
+ * worker pool, of msc_jobs slots
+ */
+static struct msc_job * msc_job_list = NULL;
+
+/**
+ * number of running workers, and number of units that did not compile
+ */
+static int msc_job_count = 0;
+static int msc_job_failed = 0;
+
+/**
+ * start a tool on msc files, with its standard output discarded. Paths are given as arguments, never through a shell.
+ * return -1 if the tool cannot be started, 0 otherwise
+ */
+static int msc_spawn(pid_t * pid, char ** argv)
+{
+   extern char ** environ;
+   posix_spawn_file_actions_t actions;
+   int rc;
+
+   posix_spawn_file_actions_init(&actions);
+   posix_spawn_file_actions_addopen(&actions, 1, "/dev/null", O_WRONLY, 0);
+   rc = posix_spawnp(pid, argv[0], &actions, NULL, argv, environ);
+   posix_spawn_file_actions_destroy(&actions);
+
+   if(rc != 0)
+   {
+      ERROR("Cannot start %s\n", argv[0]);
+      return -1;
+   }
+   return 0;
+}
+
+/**
+ * start the process of the current step of a job
+ * return -1 if the process cannot be started, 0 otherwise
+ */
+static int msc_job_spawn(struct msc_job * job)
+{
+   char dir[RT_CFG_MAX_TEXT_LEN + 32] = "-output-directory=.";
+   char tex[RT_CFG_MAX_TEXT_LEN + 16];
+   char dvi[RT_CFG_MAX_TEXT_LEN + 16];
+   char pdf[RT_CFG_MAX_TEXT_LEN + 16];
+   char * latex[]  = { "latex", "-interaction=batchmode", dir, tex, NULL };
+   char * dvipdf[] = { "dvipdf", dvi, pdf, NULL };
+   char ** argv = (job->step == MSC_JOB_LATEX) ? latex : dvipdf;
+   char * p = string_rchr(msc_base, '/');
+
+   // latex writes its files in the current directory by default
+   if(p)
+   {
+      int n = string_len("-output-directory=");
+      string_ncpy(dir + n, msc_base, p - msc_base);
+      dir[n + (p - msc_base)] = 0;
+   }
+   string_printf(tex, "%s_%04d.tex", msc_base, job->unit);
+   string_printf(dvi, "%s_%04d.dvi", msc_base, job->unit);
+   string_printf(pdf, "%s_%04d.pdf", msc_base, job->unit);
+
+   if(msc_spawn(&job->pid, argv) < 0)
+   {
+      job->pid = 0;
+      return -1;
+   }
+   VERB("msc unit %d %s by worker %d\n", job->unit, argv[0], job->pid);
+   return 0;
+}
+
+/**
+ * store <msc_base>_<unit>.pdf in the cache as <hash>.pdf. The pdf is renamed in the cache once complete,
+ * so that concurrent runs never see a partial file.
+ * return -1 if the pdf cannot be stored, 0 otherwise
+ */
+int msc_cache_put(int unit, uint64_t hash)
+{
+   char cached[RT_CFG_MAX_TEXT_LEN + 32];
+   char tmp[RT_CFG_MAX_TEXT_LEN + 48];
+   char path[RT_CFG_MAX_TEXT_LEN + 16];
+   struct stat st;
+   int in;
+   int out;
+   int rc;
+
+   string_printf(cached, "%s/%016llx.pdf", msc_cache, (unsigned long long)hash);
+   string_printf(tmp, "%s.%d", cached, (int)getpid());
+   string_printf(path, "%s_%04d.pdf", msc_base, unit);
+
+   in = open(path, O_RDONLY);
+   if(in < 0)
+      return -1;
+
+   out = open(tmp, O_CREAT|O_WRONLY|O_TRUNC, 0666);
+   rc = ((out >= 0) && (fstat(in, &st) == 0)) ? file_copy(out, in, 0, st.st_size) : -1;
+   if(out >= 0)
+      close(out);
+   close(in);
+
+   if((rc == 0) && (rename(tmp, cached) < 0))
+      rc = -1;
+   if(rc < 0)
+      unlink(tmp);
+   return rc;
+}
+
+/**
+ * a step of a job has ended: start the next one, or terminate the job
+ * return 1 if the job is terminated, 0 if it goes on
+ */
+static int msc_job_next(struct msc_job * job, int ok)
+{
+   char dvi[RT_CFG_MAX_TEXT_LEN + 16];
+
+   if(ok && (job->step == MSC_JOB_LATEX))
+   {
+      job->step = MSC_JOB_DVIPDF;
+      if(msc_job_spawn(job) == 0)
+         return 0;
+      ok = 0;
+   }
+
+   job->pid = 0;
+   msc_job_count--;
+
+   if(!ok)
+   {
+      ERROR("msc unit %s_%04d.tex does not compile\n", msc_base, job->unit);
+      msc_job_failed++;
+      return 1;
+   }
+
+   string_printf(dvi, "%s_%04d.dvi", msc_base, job->unit);
+   unlink(dvi);
+   if(job->hash && (msc_cache_put(job->unit, job->hash) < 0))
+      ERROR("Cannot store msc unit %d in the cache %s\n", job->unit, msc_cache);
+   return 1;
+}
+
+/**
+ * wait for the end of a worker. Only the processes of the workers are waited for: an ended one is taken first,
+ * or else the oldest one.
+ * return the unit compiled by the worker, or -1 if no worker is running
+ */
+int msc_job_wait(void)
+{
+   struct msc_job * job;
+   int status;
+   pid_t pid;
+   int i;
+
+   while(msc_job_count)
+   {
+      job = NULL;
+      pid = 0;
+      for(i = 0; (i < msc_jobs) && (pid == 0); i++)
+      {
+         if(msc_job_list[i].pid == 0)
+            continue;
+         job = &msc_job_list[i];
+         pid = waitpid(job->pid, &status, WNOHANG);
+      }
+
+      if(pid == 0)
+      {
+         job = NULL;
+         for(i = 0; i < msc_jobs; i++)
+         {
+            if(msc_job_list[i].pid && ((job == NULL) || (msc_job_list[i].unit < job->unit)))
+               job = &msc_job_list[i];
+         }
+         pid = waitpid(job->pid, &status, 0);
+      }
+
+      if(pid < 0)
+      {
+         if(errno == EINTR)
+            continue;
+         ERROR("Lost the msc worker %d\n", job->pid);
+         status = -1;
+      }
+
+      if(msc_job_next(job, (pid > 0) && WIFEXITED(status) && (WEXITSTATUS(status) == 0)))
+         return job->unit;
+   }
+   return -1;
+}
+
+/**
+ * compile a terminated unit to <msc_base>_<unit>.pdf in a worker process. Waits for a worker if all are busy.
+ * With a cache, the pdf is then stored in the cache as <hash>.pdf
+ * return -1 if the worker cannot be started, 0 otherwise
+ */
+int msc_job_start(int unit, uint64_t hash)
+{
+   struct msc_job * job = msc_job_list;
+
+   while(msc_job_count >= msc_jobs)
+      msc_job_wait();
+
+   while(job->pid)
+      job++;
+
+   job->unit = unit;
+   job->step = MSC_JOB_LATEX;
+   job->hash = hash;
+   if(msc_job_spawn(job) < 0)
+   {
+      msc_job_failed++;
+      return -1;
+   }
+   msc_job_count++;
+   return 0;
+}
+
+/**
+ * hash of a terminated msc unit. Its latex text includes the paper size and the layout of its pages, and
+ * instances are named by their uid, so that an unchanged unit has the same hash from one run to another.
+ * return 0 if the unit cannot be read
+ */
+uint64_t msc_unit_hash(int fd)
+{
+   char buf[4096];
+   uint64_t h = HASH_DATA_INIT;
+   off_t off = 0;
+   ssize_t n;
+
+   while((n = pread(fd, buf, sizeof(buf), off)) > 0)
+   {
+      h = hash_data(h, buf, n);
+      off += n;
+   }
+   return (n < 0) ? 0 : h;
+}
+
+/**
+ * get <msc_base>_<unit>.pdf from the cache, by a hard link or else by a copy
+ * return -1 if the unit is not in the cache, 0 otherwise
+ */
+int msc_cache_get(int unit, uint64_t hash)
+{
+   char cached[RT_CFG_MAX_TEXT_LEN + 32];
+   char path[RT_CFG_MAX_TEXT_LEN + 16];
+   struct stat st;
+   int in;
+   int out;
+   int rc;
+
+   string_printf(cached, "%s/%016llx.pdf", msc_cache, (unsigned long long)hash);
+   string_printf(path, "%s_%04d.pdf", msc_base, unit);
+
+   unlink(path);
+   if(link(cached, path) == 0)
+      return 0;
+
+   in = open(cached, O_RDONLY);
+   if(in < 0)
+      return -1;
+
+   out = open(path, O_CREAT|O_WRONLY|O_TRUNC, 0666);
+   rc = ((out >= 0) && (fstat(in, &st) == 0)) ? file_copy(out, in, 0, st.st_size) : -1;
+   if(out >= 0)
+      close(out);
+   close(in);
+   return rc;
+}
+
+/**
+ * start the next msc unit, a standalone latex document of up to msc_batch pages
+ * return -1 if the unit cannot be created, 0 otherwise
+ */
+int msc_unit_open(void)
+{
+   char path[RT_CFG_MAX_TEXT_LEN + 16];
+
+   string_printf(path, "%s_%04d.tex", msc_base, msc_unit);
+   msc_fd = open(path, O_CREAT|O_RDWR|O_TRUNC, 0666);
+   if(msc_fd < 0)
+   {
+      ERROR("Cannot open %s for write\n", path);
+      return -1;
+   }
+
+   msc_unit_pages     = 0;
+   msc_unit_instances = 0;
+
+   sink_open(msc_fd);
+   msc_new_doc(msc_fd);
+   return 0;
+}
+
+/**
+ * terminate the current msc unit, with the paper size of its own pages, and hand it over to a worker,
+ * unless the same unit is already compiled in the cache
+ */
+void msc_unit_close(void)
+{
+   uint64_t hash = 0;
+
+   msc_end_doc(msc_fd);
+   sink_close(msc_fd);
+   if(msc_set_geometry(msc_fd, msc_paper_width(msc_unit_instances), msc_paper_height()) < 0)
+      ERROR("Cannot write the paper size of msc unit %d\n", msc_unit);
+   if(string_len(msc_cache) > 0)
+      hash = msc_unit_hash(msc_fd);
+   close(msc_fd);
+   msc_fd = -1;
+
+   if(hash && (msc_cache_get(msc_unit, hash) == 0))
+   {
+      VERB("msc unit %d found in the cache as %016llx\n", msc_unit, (unsigned long long)hash);
+      msc_cache_hits++;
+   }
+   else
+   {
+      msc_job_start(msc_unit, hash);
+   }
+   msc_unit++;
+}
+
+/**
+ * wait for all workers, then merge the pdf files of all units in <msc_base>.pdf
+ * return -1 if a unit did not compile or if the merge fails, 0 otherwise
+ */
+int msc_merge(void)
+{
+   char ** argv;
+   char * paths;
+   int size = string_len(msc_base) + 16;
+   int status = -1;
+   pid_t pid;
+   int i;
+
+   while(msc_job_wait() >= 0);
+
+   if(msc_job_failed)
+   {
+      ERROR("%d msc units do not compile, %s.pdf is not merged\n", msc_job_failed, msc_base);
+      return -1;
+   }
+
+   // gs options, the output, then the pdf of each unit
+   argv  = (char **)heap_alloc((msc_unit + 7) * sizeof(char *));
+   paths = (char *)heap_alloc((msc_unit + 1) * size + 16);
+   if((argv == NULL) || (paths == NULL))
+   {
+      heap_free(argv);
+      heap_free(paths);
+      return -1;
+   }
+
+   argv[0] = "gs";
+   argv[1] = "-q";
+   argv[2] = "-dNOPAUSE";
+   argv[3] = "-dBATCH";
+   argv[4] = "-sDEVICE=pdfwrite";
+   argv[5] = paths;
+   string_printf(paths, "-sOutputFile=%s.pdf", msc_base);
+   for(i = 0; i < msc_unit; i++)
+   {
+      argv[6 + i] = paths + 16 + (i + 1) * size;
+      string_printf(argv[6 + i], "%s_%04d.pdf", msc_base, i);
+   }
+   argv[6 + msc_unit] = NULL;
+
+   INFO("merge %d msc units in %s.pdf ...\n", msc_unit, msc_base);
+   if(msc_spawn(&pid, argv) == 0)
+   {
+      while((waitpid(pid, &status, 0) < 0) && (errno == EINTR));
+   }
+   heap_free(argv);
+   heap_free(paths);
+   if(!WIFEXITED(status) || (WEXITSTATUS(status) != 0))
+   {
+      ERROR("Cannot merge the msc units in %s.pdf\n", msc_base);
+      return -1;
+   }
+
+   for(i = 0; i < msc_unit; i++)
+   {
+      char path[RT_CFG_MAX_TEXT_LEN + 16];
+      string_printf(path, "%s_%04d.pdf", msc_base, i);
+      unlink(path);
+   }
+   return 0;
+}
+
+/**
+ * initialize the reader of a source. Regular files are mapped in memory, other inputs (pipes, terminals)
+ * are read by blocks of RT_READ_BUF_SIZE bytes.
+ * return -1 if memory is missing, 0 otherwise
+ */
+int source_open_reader(struct rt_source * src, int binary)
+{
+   struct stat st;
+
+   src->binary = binary;
+   src->pos    = 0;
+   src->len    = 0;
+   src->end    = 0;
+   src->last   = NULL;
+   src->mapped = 0;
+
+   if((fstat(src->fd, &st) == 0) && S_ISREG(st.st_mode))
+   {
+      src->end  = 1;
+      src->size = st.st_size;
+      if(src->size == 0)
+      {
+         src->data = NULL;
+         return 0;
+      }
+
+      // text lines are terminated in place: the mapping is private
+      src->data = (char *)mmap(NULL, src->size, PROT_READ | PROT_WRITE, MAP_PRIVATE, src->fd, 0);
+      if(src->data != MAP_FAILED)
+      {
+         src->mapped = 1;
+         src->len    = src->size;
+         madvise(src->data, src->size, MADV_SEQUENTIAL);
+         return 0;
+      }
+      INFO("fd %d cannot be mapped, read it by blocks\n", src->fd);
+      src->end = 0;
+   }
+
+   src->size = RT_READ_BUF_SIZE;
+   src->data = (char *)heap_alloc(src->size);
+   return src->data ? 0 : -1;
+}
+
+/**
+ * release the memory of the reader of a source
+ */
+void source_close_reader(struct rt_source * src)
+{
+   if(src->mapped)
+      munmap(src->data, src->size);
+   else
+      heap_free(src->data);
+
+   heap_free(src->last);
+   src->data   = NULL;
+   src->last   = NULL;
+   src->mapped = 0;
+   src->pos    = 0;
+   src->len    = 0;
+}
+
+/**
+ * extract the next complete record from the data of a source, without copying it:
+ * - a line in text mode: its '\n' is replaced by a zero. The last line of the input may not be terminated.
+ * - a block of data in binary mode: each data block has a 8 bit header indicating the length of the data block
+ *   that follow.
+ * return the length of the record (including the '\n' in text mode), 0 if the input is broken or completely read,
+ * -1 if the record is not completely read yet
+ */
+static int source_record(struct rt_source * src, char ** record)
+{
+   size_t avail = src->len - src->pos;
+   char * p = src->data + src->pos;
+   char * eol;
+   int len;
+
+   if(avail == 0)
+      return src->end ? 0 : -1;
+
+   if(src->binary)
+   {
+      len = (char)p[0];
+      if((len <= 0) || (len > RT_CFG_MAX_COMMAND_LEN))
+         return 0;
+      if(len + 1 > avail)
+         return src->end ? 0 : -1;
+
+      *record = p + 1;
+      src->pos += len + 1;
+      return len;
+   }
+
+   eol = (char *)mem_chr(p, '\n', avail);
+   if(eol)
+   {
+      *eol = '\0';
+      len = eol - p + 1;
+   }
+   else if(src->end || (src->pos == 0 && avail == src->size - 1))
+   {
+      // last line of the input, or line longer than the read buffer
+      len = avail;
+      if(src->mapped)
+      {
+         heap_free(src->last);
+         src->last = (char *)heap_alloc(len + 1);
+         if(src->last == NULL)
+            return 0;
+         mem_cpy(src->last, p, len);
+         p = src->last;
+      }
+      p[len] = '\0';
+   }
+   else
+   {
+      return -1;
+   }
+
+   // longer lines are truncated
+   if(len > RT_CFG_MAX_COMMAND_LEN)
+   {
+      ERROR("line truncated to %d characters\n", RT_CFG_MAX_COMMAND_LEN - 1);
+      p[RT_CFG_MAX_COMMAND_LEN - 1] = '\0';
+   }
+
+   *record = p;
+   src->pos += len;
+   return len;
+}
+
+/**
+ * Return 1 if a complete record of the source can be extracted without reading its input
+ */
+int source_pending(struct rt_source * src)
+{
+   size_t avail = src->len - src->pos;
+   char * p = src->data + src->pos;
+
+   if(src->end || src->ready || !src->polled)
+      return 1;
+   if(avail == 0)
+      return 0;
+   if(src->binary)
+      return ((char)p[0] <= 0) || ((char)p[0] < avail);
+   return (mem_chr(p, '\n', avail) != NULL) || (src->pos == 0 && avail == src->size - 1);
+}
+
+/**
+ * Return the next record of a source (see source_record).
+ * If no complete record is buffered and ready is set, the input is read once: it must not block.
+ * return the length of the record, 0 at the end of the input, -1 if no complete record is available yet.
+ */
+int source_next(struct rt_source * src, int ready, char ** record)
+{
+   int len = source_record(src, record);
+   int rc;
+
+   if((len >= 0) || !ready)
+      return len;
+
+   // keep the beginning of the pending record, and fill the buffer. One byte is kept to terminate a last line.
+   if(src->pos > 0)
+   {
+      mem_move(src->data, src->data + src->pos, src->len - src->pos);
+      src->len -= src->pos;
+      src->pos  = 0;
+   }
+
+   rc = read(src->fd, src->data + src->len, src->size - 1 - src->len);
+   if(rc <= 0)
+      src->end = 1;
+   else
+      src->len += rc;
+
+   return source_record(src, record);
+}
+
+
+/**
+ * Display the content of a message.
+ * For debug only.
+ */
+void print_msg(struct rt_msg * m)
+{
+   fprintf(stdout, "cmd  %d (%s)", m->cmd, rt_cmd_name(m->cmd));
+   fprintf(stdout, ", time %d", m->time);
+   fprintf(stdout, ", gid  %lx", m->gid);
+   fprintf(stdout, ", fid  %x", m->fid);
+   fprintf(stdout, ", id1  %lx", m->id1);
+   fprintf(stdout, ", id2  %lx", m->id2);
+   fprintf(stdout, ", text '%s'\n", m->text);
+}
+
+/**
+ * Return the shared copy of a text, with one more reference. NULL is returned for an empty text.
+ */
+struct rt_text * text_get(const char * str)
+{
+   hash_node_t * pos;
+   struct rt_text * t;
+   uint32_t h;
+   int len;
+
+   if(str[0] == '\0')
+      return NULL;
+
+   h = hash_string(str);
+   hash_for_each(pos, &rt_text_index, h)
+   {
+      t = hash_entry(pos, struct rt_text, node);
+      if(string_cmp(t->str, str) == 0)
+      {
+         t->ref++;
+         return t;
+      }
+   }
+
+   len = string_len(str);
+   t = (struct rt_text *)heap_alloc(sizeof(struct rt_text) + len + 1);
+   if(t == NULL)
+   {
+      ERROR("Cannot allocate text '%s'\n", str);
+      return NULL;
+   }
+   t->ref    = 1;
+   t->key    = NULL;
+   string_cpy(t->str, str);
+   hash_insert(&rt_text_index, &t->node, h);
+   return t;
+}
+
+/**
+ * Release one reference on a text
+ */
+void text_put(struct rt_text * t)
+{
+   if((t == NULL) || (--t->ref > 0))
+      return;
+
+   hash_delete(&rt_text_index, &t->node);
+   if(t->key != t)
+      text_put(t->key);
+   heap_free(t);
+}
+
+/**
+ * Return the text without separators, as written in vcd files. The key is computed once, and lives as long as the
+ * text.
+ */
+struct rt_text * text_key(struct rt_text * t)
+{
+   char key[RT_CFG_MAX_COMMAND_LEN];
+
+   if((t == NULL) || t->key)
+      return t ? t->key : NULL;
+
+   generate_key(key, t->str);
+   if(string_cmp(key, t->str) == 0)
+      t->key = t;
+   else
+      t->key = text_get(key);
+
+   return t->key;
+}
+
+/**
+ * expand a queued message, to process it
+ */
+void event_to_msg(struct rt_event * e, struct rt_msg * m)
+{
+   m->cmd        = e->cmd;
+   m->time       = e->time;
+   m->fid        = e->fid;
+   m->gid        = e->gid;
+   m->id1        = e->id1;
+   m->id2        = e->id2;
+   m->txt        = e->text;
+   m->text       = text_str(e->text);
+   m->class      = classify_cmd(e->cmd);
+   m->msc_level  = 0;
+   m->vcd_level  = 0;
+   m->off        = e->off;
+   m->corr       = (e->flags & RT_EVENT_CORR) ? 1 : 0;
+   m->corr_cmd   = RT_DEF_CMD_MAX;
+   m->corr_event = NULL;
+   m->aggr       = (e->flags & RT_EVENT_AGGR) ? 1 : 0;
+   m->obj1       = NULL;
+   m->obj2       = NULL;
+   m->group      = NULL;
+}
+
+/**
+ * send_msg and timeout are priorized: at the same time, they are queued before other messages
+ */
+static inline int msg_is_prio(struct rt_event * m)
+{
+   return (m->cmd == RT_DEF_CMD_SENDMSG) || (m->cmd == RT_DEF_CMD_TIMEOUT);
+}
+
+/**
+ * Return 1 if message a is queued before message b in the rt_queue.
+ * Messages are sorted by time. At the same time, priorized messages come first, the last arrived
+ * one in front, then other messages in their arrival order.
+ */
+int msg_before(struct rt_event * a, struct rt_event * b)
+{
+   if(a->time != b->time)
+      return a->time < b->time;
+
+   if(msg_is_prio(a) != msg_is_prio(b))
+      return msg_is_prio(a);
+
+   if(msg_is_prio(a))
+      return a->seq > b->seq;
+   else
+      return a->seq < b->seq;
+}
+
+/**
+ * 1 if a queued message may be the reception of a message or of a timer
+ */
+static inline int corr_candidate(struct rt_event * m)
+{
+   return (m->cmd == RT_DEF_CMD_RECVMSG) || (m->cmd == RT_DEF_CMD_TIMEOUT) || (m->cmd == RT_DEF_CMD_STOPTIMER);
+}
+
+static inline uint32_t corr_hash(object_id_t id1, object_id_t id2, struct rt_text * text)
+{
+   return hash_combine(hash_combine(hash_u64(id1), hash_u64(id2)), hash_u64((uintptr_t)text));
+}
+
+/**
+ * Return the entry of the correlation index of (id1, id2, text). If it does not exist, it is created if create
+ * is set, otherwise NULL is returned.
+ */
+struct rt_corr * corr_entry(object_id_t id1, object_id_t id2, struct rt_text * text, int create)
+{
+   hash_node_t * pos;
+   struct rt_corr * c;
+   uint32_t h = corr_hash(id1, id2, text);
+
+   hash_for_each(pos, &rt_corr_index, h)
+   {
+      c = hash_entry(pos, struct rt_corr, node);
+      if((c->id1 == id1) && (c->id2 == id2) && (c->text == text))
+         return c;
+   }
+   if(!create)
+      return NULL;
+
+   c = (struct rt_corr *)heap_alloc(sizeof(struct rt_corr));
+   if(c == NULL)
+      return NULL;
+   c->id1    = id1;
+   c->id2    = id2;
+   c->text   = text;
+   c->count  = 0;
+   c->max    = 0;
+   c->queued = NULL;
+   hash_insert(&rt_corr_index, &c->node, h);
+   return c;
+}
+
+/**
+ * add a message to an entry of the correlation index, in rt_queue order
+ * return -1 if memory is missing, 0 otherwise
+ */
+static int corr_queued_add(struct rt_corr * c, struct rt_event * m)
+{
+   int i;
+
+   if(c->count == c->max)
+   {
+      int max = c->max ? 2 * c->max : 4;
+      struct rt_event ** queued = (struct rt_event **)heap_realloc(c->queued, max * sizeof(struct rt_event *));
+      if(queued == NULL)
+         return -1;
+      c->queued = queued;
+      c->max    = max;
+   }
+
+   i = c->count++;
+   while((i > 0) && msg_before(m, c->queued[i - 1]))
+   {
+      c->queued[i] = c->queued[i - 1];
+      i--;
+   }
+   c->queued[i] = m;
+   return 0;
+}
+
+/**
+ * add a queued message to the correlation index of its identifiers and text, if it may be a reception
+ */
+void corr_index_add(struct rt_event * m)
+{
+   struct rt_corr * c;
+
+   m->corr = NULL;
+   if(!corr_candidate(m))
+      return;
+
+   c = corr_entry(m->id1, m->id2, m->text, 1);
+   if((c == NULL) || (corr_queued_add(c, m) < 0))
+   {
+      ERROR("Cannot index message '%s' at @%d\n", rt_cmd_name(m->cmd), m->time);
+      return;
+   }
+   m->corr = c;
+}
+
+/**
+ * remove a message from the correlation index, when it leaves the rt_queue
+ */
+void corr_index_del(struct rt_event * m)
+{
+   struct rt_corr * c = m->corr;
+   int i;
+
+   if(c == NULL)
+      return;
+
+   for(i = 0; i < c->count; i++)
+   {
+      if(c->queued[i] == m)
+      {
+         c->count--;
+         mem_move(&c->queued[i], &c->queued[i + 1], (c->count - i) * sizeof(struct rt_event *));
+         break;
+      }
+   }
+
+   if(c->count == 0)
+   {
+      hash_delete(&rt_corr_index, &c->node);
+      heap_free(c->queued);
+      heap_free(c);
+   }
+}
+
+/**
+ * return the first message of an entry of the correlation index whose identifiers name obj1 and obj2 now,
+ * or NULL
+ */
+static struct rt_event * corr_first(struct rt_corr * c, struct rt_object * obj1, struct rt_object * obj2)
+{
+   struct rt_event * k;
+   int i;
+
+   for(i = 0; (c != NULL) && (i < c->count); i++)
+   {
+      k = c->queued[i];
+      if( (find_object(k->fid, k->id1) == obj1)
+       && (find_object(k->fid, k->id2) == obj2))
+      {
+         return k;
+      }
+   }
+   return NULL;
+}
+
+/**
+ * Find a simular message to the one passed as argument
+ * - id1 and id2 must match
+ * - text must match
+ *
+ * Note: only receptions are matched. If several messages match, the first one in the rt_queue is returned.
+ * A message names an object by its oid, or by its global identifier: only the entries of the correlation index
+ * of these identifiers are checked, with the objects existing now.
+ */
+struct rt_event * msc_find_msg(struct rt_msg * m)
+{
+   struct rt_event * first = NULL;
+   struct rt_event * k;
+   struct rt_object * obj1;
+   struct rt_object * obj2;
+   object_id_t ids1[2];
+   object_id_t ids2[2];
+   int n1 = 0;
+   int n2 = 0;
+   int i;
+   int j;
+
+   obj1 = find_object(m->fid, m->id1);
+   if(!obj1)
+      return NULL;
+   obj2 = find_object(m->fid, m->id2);
+   if(!obj2)
+      return NULL;
+
+   ids1[n1++] = obj1->oid;
+   if(obj1->global && (obj1->global_id != obj1->oid))
+      ids1[n1++] = obj1->global_id;
+   ids2[n2++] = obj2->oid;
+   if(obj2->global && (obj2->global_id != obj2->oid))
+      ids2[n2++] = obj2->global_id;
+
+   for(i = 0; i < n1; i++)
+   {
+      for(j = 0; j < n2; j++)
+      {
+         k = corr_first(corr_entry(ids1[i], ids2[j], m->txt, 0), obj1, obj2);
+         if(k && ((first == NULL) || msg_before(k, first)))
+            first = k;
+      }
+   }
+   return first;
+}
+
+void exec_decltask(struct rt_msg * m)
+{
+   m->obj1->quantification = 0;
+   if(msc_out)
+   {
+      msc_page_instances++;
+      write_line(msc_fd, "\\declinst{%x}{task}{%s}\n", m->obj1->uid, m->text);
+      svg_declinst(m->obj1, "task", m->text);
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_def_out)
+   {
+      // status of the process at os level
+      write_line(vcd_def_fd, "$var wire 1 ^%x %s->task $end\n", m->obj1, text_str(m->obj1->key));
+
+      // state of the process
+      write_line(vcd_def_fd, "$var string 0 $%x %s->state $end\n", m->obj1, text_str(m->obj1->key));
+   }
+}
+
+void exec_declmutex(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+      msc_page_instances++;
+      write_line(msc_fd, "\\declinst{%x}{mutex}{%s}\n", m->obj1->uid, m->text);
+      svg_declinst(m->obj1, "mutex", m->text);
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_def_out)
+   {
+      // status of the mutex
+      write_line(vcd_def_fd, "$var wire 1 ^%x %s $end\n", m->obj1, text_str(m->obj1->key));
+   }
+}
+
+void exec_declobj(struct rt_msg * m)
+{
+   char text[RT_CFG_MAX_TEXT_LEN];
+   char *p = string_cpy(text, m->text);
+   char *inst_name;
+   char *inst_type;
+   inst_type = string_sep(&p, "\t ");
+   inst_name = string_sep(&p, "\t ");
+   m->obj1->quantification = 0;
+   if(msc_out)
+   {
+      msc_page_instances++;
+      write_line(msc_fd, "\\declinst{%x}{%s}{%s}\n", m->obj1->uid, inst_type, inst_name);
+      svg_declinst(m->obj1, inst_type, inst_name);
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_def_out)
+   {
+      // status of the object
+      write_line(vcd_def_fd, "$var wire 1 ^%x %s->call $end\n", m->obj1, inst_name);
+
+      // state of the object.
+      write_line(vcd_def_fd, "$var string 0 $%x %s->state $end\n", m->obj1, inst_name);
+   }
+}
+
+/**
+ * find a similar message.
+ * Apply only to the following messages:
+ *    - RT_DEF_CMD_SENDMSG
+ *    - RT_DEF_CMD_SETTIMER
+ * If message is correlated to one message of the queue, the following fields are changed:
+ *    - m->off is set to k->time - m->time
+ *    - m->corr is set, m->corr_event is set to k
+ *    - k is flagged as correlated (RT_EVENT_CORR)
+ *    - k->off is set to - m->off
+ *    - 1 is returned
+ * Else:
+ *    - 0 is returned
+ */
+int msc_find_corr(struct rt_msg * m)
+{
+   struct rt_event * k;
+   struct rt_msg msg;
+
+   if ((m->cmd == RT_DEF_CMD_SENDMSG) || (m->cmd == RT_DEF_CMD_SETTIMER))
+   {
+      k = msc_find_msg(m);
+
+      // if message is lost, offset is kept to -1
+      if (k)
+      {
+         // logical order: the received message should have a reception time more recent (or =)
+         if (k->time < m->time)
+         {
+            ERROR("logical condition broken\n");
+            ERROR(" => recvmsg:\n");
+            event_to_msg(k, &msg);
+            print_msg(&msg);
+            ERROR(" => sendmsg:\n");
+            print_msg(m);
+         }
+         else
+         {
+					 	INFO("correlation found");
+            m->off        = msc_untimed ? (untimed_levels(k) - m->msc_level) : (k->time - m->time);
+            m->corr       = 1;
+            m->corr_cmd   = k->cmd;
+            m->corr_event = k;
+            k->off        = -m->off;
+            k->flags     |= RT_EVENT_CORR;
+            return 1;
+         }
+      }
+   }
+   return 0;
+}
+
+void exec_sendmsg(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+      if(!m->corr)
+      {
+         write_line(msc_fd, "\\lost[r]{%s}{}{%x}\n", m->text, m->obj1->uid);
+         svg_lost(m->text, m->obj1);
+      }
+      else
+      {
+         write_line(msc_fd, "\\mess{%s}{%x}[0.1]{%x}[%d]\n", m->text, m->obj1->uid, m->obj2->uid, m->off);
+         svg_mess(m->text, m->obj1, m->obj2, m->off, 0);
+      }
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_out)
+   {
+   }
+}
+
+void exec_call(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+      write_line(msc_fd, "\\mess{%s}{%x}{%x}\n", m->text, m->obj1->uid, m->obj2->uid);
+      svg_mess(m->text, m->obj1, m->obj2, 0, 0);
+      if(m->obj2->status != RT_OBJECT_RUN)
+      {
+         write_line(msc_fd, "\\regionstart{activation}{%x}\n", m->obj2->uid);
+         svg_region_start(m->obj2, SVG_REGION_ACTIVATION);
+      }
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_out)
+   {
+      if(m->obj2->status != RT_OBJECT_RUN)
+         write_scalar(vcd_fd, '1', '^', m->obj2, 1);
+   }
+   m->obj2->status = RT_OBJECT_RUN;
+}
+
+void exec_recvmsg(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+      if(!m->corr)
+      {
+         write_line(msc_fd, "\\found[r]{%s}{}{%x}\n", m->text, m->obj1->uid);
+         svg_found(m->text, m->obj1);
+      }
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_out)
+   {
+   }
+}
+
+void exec_sleep(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+      if(m->obj1->status != RT_OBJECT_WAIT)
+      {
+         write_line(msc_fd, "\\regionstart{coregion}{%x}\n", m->obj1->uid);
+         svg_region_start(m->obj1, SVG_REGION_COREGION);
+      }
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_out)
+   {
+      if(m->obj1->status != RT_OBJECT_WAIT)
+         write_scalar(vcd_fd, '1', '^', m->obj1, 1);
+   }
+
+   m->obj1->status = RT_OBJECT_WAIT;
+}
+
+void exec_switch(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+      write_line(msc_fd, "\\mess*{switch}{%x}{%x}\n", m->obj1->uid, m->obj2->uid);
+      svg_mess("switch", m->obj1, m->obj2, 0, 1);
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_out)
+   {
+   }
+}
+
+void exec_return(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+      write_line(msc_fd, "\\order{%x}{%x}\n", m->obj1->uid, m->obj2->uid);
+      svg_order(m->obj1, m->obj2);
+      if(m->obj1->status == RT_OBJECT_RUN)
+      {
+         write_line(msc_fd, "\\regionend{%x}\n", m->obj1->uid);
+         svg_region_end(m->obj1);
+      }
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_out)
+   {
+      if(m->obj1->status == RT_OBJECT_RUN)
+         write_scalar(vcd_fd, '0', '^', m->obj1, 1);
+   }
+   m->obj1->status = RT_OBJECT_READY;
+}
+
+void exec_comment(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+      write_line(msc_fd, "\\msccomment[%c]{%s}{%x}\n", 'r', m->text, m->obj1->uid);
+      svg_comment(m->text, m->obj1);
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_out)
+   {
+   }
+}
+
+void exec_action(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+      write_line(msc_fd, "\\action*{%s}{%x}\n", m->text, m->obj1->uid);
+      svg_action(m->text, m->obj1);
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_out)
+   {
+   }
+}
+
+void exec_settimer(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+      if(!m->corr)
+      {
+         write_line(msc_fd, "\\settimer[r]{%s}{%x}\n", m->text, m->obj1->uid);
+         svg_timer(SVG_TIMER_SET, m->text, m->obj1, 0);
+      }
+      else if(m->corr_cmd == RT_DEF_CMD_TIMEOUT)
+      {
+         write_line(msc_fd, "\\settimeout[r]{%s}{%x}[%d]\n", m->text, m->obj1->uid, m->off);
+         svg_timer(SVG_TIMER_SET_TIMEOUT, m->text, m->obj1, m->off);
+      }
+      else if(m->corr_cmd == RT_DEF_CMD_STOPTIMER)
+      {
+         write_line(msc_fd, "\\setstoptimer[r]{%s}{%x}[%d]\n", m->text, m->obj1->uid, m->off);
+         svg_timer(SVG_TIMER_SET_STOP, m->text, m->obj1, m->off);
+      }
+   }
+
+   if(msc_out)
+   {
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_out)
+   {
+   }
+}
+
+void exec_exptimer(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+      if(!m->corr)
+      {
+         write_line(msc_fd, "\\timeout[r]{%s}{%x}\n", m->text, m->obj1->uid);
+         svg_timer(SVG_TIMER_TIMEOUT, m->text, m->obj1, 0);
+      }
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_out)
+   {
+   }
+}
+
+void exec_stoptimer(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+      if(!m->corr)
+      {
+         write_line(msc_fd, "\\stoptimer[r]{%s}{%x}\n", m->text, m->obj1->uid);
+         svg_timer(SVG_TIMER_STOP, m->text, m->obj1, 0);
+      }
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_out)
+   {
+   }
+}
+
+void exec_ready(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+      if(m->obj1->status != RT_OBJECT_READY)
+      {
+         write_line(msc_fd, "\\regionend{%x}\n", m->obj1->uid);
+         svg_region_end(m->obj1);
+      }
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_out)
+   {
+      if(m->obj1->status != RT_OBJECT_READY)
+         write_scalar(vcd_fd, '0', '^', m->obj1, 1);
+   }
+
+   m->obj1->status = RT_OBJECT_READY;
+}
+
+void exec_suspend(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+      if(m->obj1->status != RT_OBJECT_PREEMPT)
+      {
+         write_line(msc_fd, "\\regionstart{suspension}{%x}\n", m->obj1->uid);
+         svg_region_start(m->obj1, SVG_REGION_SUSPENSION);
+      }
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_out)
+   {
+      if(m->obj1->status != RT_OBJECT_PREEMPT)
+         write_scalar(vcd_fd, 'x', '^', m->obj1, 1);
+   }
+   m->obj1->status = RT_OBJECT_PREEMPT;
+}
+
+void exec_creattask(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+      msc_page_instances++;
+      write_line(msc_fd, "\\dummyinst{%x}\n", m->obj2->uid);
+      write_line(msc_fd, "\\create{spawn}[t]{%x}[0.5]{%x}{task}{%s}\n", m->obj1->uid, m->obj2->uid, m->text);
+      svg_dummyinst(m->obj2);
+      svg_create("spawn", m->obj1, m->obj2, "task", m->text);
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_def_out)
+   {
+      // status of the process
+      write_line(vcd_def_fd, "$var wire 1 ^%x %s->task $end\n", m->obj2, text_str(m->obj2->key));
+
+      // value (user state) of the process
+      write_line(vcd_def_fd, "$var string 0 $%x %s->state $end\n", m->obj2, text_str(m->obj2->key));
+   }
+   if(vcd_out)
+   {
+      // dynamically created task are ready
+      write_scalar(vcd_fd, '0', '^', m->obj2, 1);
+   }
+}
+
+void exec_creatmutex(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+      msc_page_instances++;
+      write_line(msc_fd, "\\dummyinst{%x}\n", m->obj2->uid);
+      write_line(msc_fd, "\\create{}[t]{%x}[0.5]{%x}{mutex}{%s}\n", m->obj1->uid, m->obj2->uid, m->text);
+      svg_dummyinst(m->obj2);
+      svg_create("", m->obj1, m->obj2, "mutex", m->text);
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_def_out)
+   {
+      // status of the mutex
+      write_line(vcd_def_fd, "$var wire 1 ^%x %s $end\n", m->obj2, text_str(m->obj2->key));
+   }
+   if(vcd_out)
+   {
+      write_scalar(vcd_fd, '0', '^', m->obj2, 1);
+   }
+}
+
+void exec_creatobj(struct rt_msg * m)
+{
+   char text[RT_CFG_MAX_TEXT_LEN];
+   char *p = string_cpy(text, m->text);
+   char *inst_name;
+   char *inst_type;
+   inst_type = string_sep(&p, "\t ");
+   inst_name = string_sep(&p, "\t ");
+   if(msc_out)
+   {
+      msc_page_instances++;
+      write_line(msc_fd, "\\dummyinst{%x}\n", m->obj2->uid);
+      write_line(msc_fd, "\\create{}[t]{%x}[0.5]{%x}{%s}{%s}\n", m->obj1->uid, m->obj2->uid, inst_name, inst_type);
+      svg_dummyinst(m->obj2);
+      svg_create("", m->obj1, m->obj2, inst_name, inst_type);
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_def_out)
+   {
+      // status of the object
+      write_line(vcd_def_fd, "$var wire 1 ^%x %s->call $end\n", m->obj2, inst_name);
+
+      // value (user state) of the object.
+      write_line(vcd_def_fd, "$var string 0 $%x %s->state $end\n", m->obj2, inst_name);
+   }
+   if(vcd_out)
+   {
+      write_scalar(vcd_fd, '0', '^', m->obj2, 1);
+   }
+}
+
+void exec_take(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+      write_line(msc_fd, "\\mess{take}{%x}{%x}\n", m->obj1->uid, m->obj2->uid);
+      svg_mess("take", m->obj1, m->obj2, 0, 0);
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_out)
+   {
+   }
+}
+
+void exec_give(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+      write_line(msc_fd, "\\mess{give}{%x}{%x}\n", m->obj1->uid, m->obj2->uid);
+      svg_mess("give", m->obj1, m->obj2, 0, 0);
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_out)
+   {
+   }
+}
+
+void exec_delmutex(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+      write_line(msc_fd, "\\stop{%x}\n", m->obj2->uid);
+      svg_stop(m->obj2);
+      if(m->obj1 != m->obj2)
+      {
+         write_line(msc_fd, "\\mess{}{%x}{%x}\n", m->obj1->uid, m->obj2->uid);
+         svg_mess("", m->obj1, m->obj2, 0, 0);
+      }
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_out)
+   {
+      write_scalar(vcd_fd, 'x', '^', m->obj2, 1);
+   }
+}
+
+void exec_deltask(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+      write_line(msc_fd, "\\stop{%x}\n", m->obj2->uid);
+      svg_stop(m->obj2);
+      if(m->obj1 != m->obj2)
+      {
+         write_line(msc_fd, "\\mess{kill}{%x}{%x}\n", m->obj1->uid, m->obj2->uid);
+         svg_mess("kill", m->obj1, m->obj2, 0, 0);
+      }
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_out)
+   {
+      write_scalar(vcd_fd, 'x', '^', m->obj2, 1);
+   }
+}
+
+void exec_delobj(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+      write_line(msc_fd, "\\stop{%x}\n", m->obj2->uid);
+      svg_stop(m->obj2);
+      if(m->obj1 != m->obj2)
+      {
+         write_line(msc_fd, "\\mess{}{%x}{%x}\n", m->obj1->uid, m->obj2->uid);
+         svg_mess("", m->obj1, m->obj2, 0, 0);
+      }
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_out)
+   {
+      write_scalar(vcd_fd, 'x', '^', m->obj2, 1);
+   }
+}
+
+
+void exec_declbool(struct rt_msg * m)
+{
+   m->obj1->quantification = 1;
+   if(msc_out)
+   {
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_def_out)
+   {
+      write_line(vcd_def_fd, "$var wire 1 &%x %s $end\n", m->obj1, text_str(m->obj1->key));
+   }
+}
+
+void exec_declwire(struct rt_msg * m)
+{
+   m->obj1->quantification = m->id2;
+   if(msc_out)
+   {
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_def_out)
+   {
+      write_line(vcd_def_fd, "$var wire %d @%x %s $end\n", m->id2, m->obj1, text_str(m->obj1->key));
+   }
+}
+
+void exec_declint(struct rt_msg * m)
+{
+   m->obj1->quantification = 0;
+   if(msc_out)
+   {
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_def_out)
+   {
+      write_line(vcd_def_fd, "$var real 0 #%x %s $end\n", m->obj1, text_str(m->obj1->key));
+   }
+}
+
+void exec_declreal(struct rt_msg * m)
+{
+   m->obj1->quantification = 0;
+   if(msc_out)
+   {
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_def_out)
+   {
+      write_line(vcd_def_fd, "$var real 0 #%x %s $end\n", m->obj1, text_str(m->obj1->key));
+   }
+}
+
+void exec_declstring(struct rt_msg * m)
+{
+   m->obj1->quantification = 0;
+   if(msc_out)
+   {
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_def_out)
+   {
+      write_line(vcd_def_fd, "$var string 0 $%x %s $end\n", m->obj1, text_str(m->obj1->key));
+   }
+}
+
+void exec_declstate(struct rt_msg * m)
+{
+   m->obj1->quantification = 0;
+   if(msc_out)
+   {
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_def_out)
+   {
+      write_line(vcd_def_fd, "$var string 0 $%x %s $end\n", m->obj1, text_str(m->obj1->key));
+   }
+}
+
+void exec_setint(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_out)
+   {
+      write_line(vcd_fd, "r%d #%x\n", m->id2, m->obj1);
+   }
+   m->obj1->value = m->id2;
+}
+
+void exec_setreal(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_out)
+   {
+      write_line(vcd_fd, "r%d #%x\n", m->id2, m->obj1);
+   }
+   m->obj1->value = m->id2;
+}
+
+void exec_setstring(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_out)
+   {
+      write_line(vcd_fd, "s%s $%x\n", text_str(text_key(m->txt)), m->obj1);
+   }
+   text_hold(m->txt);
+   text_put((struct rt_text *)m->obj1->value);
+   m->obj1->value = (object_value_t)m->txt;
+}
+
+void exec_setstate(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+      write_line(msc_fd, "\\condition*{%s}{%x}\n", m->text, m->obj1->uid);
+      svg_condition(m->text, m->obj1);
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_out)
+   {
+      write_line(vcd_fd, "s%s $%x\n", text_str(text_key(m->txt)), m->obj1);
+   }
+   text_hold(m->txt);
+   text_put((struct rt_text *)m->obj1->value);
+   m->obj1->value = (object_value_t)m->txt;
+}
+
+void exec_creategrp(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_def_out)
+   {
+      write_line(vcd_def_fd, "$scope module %s $end\n", text_str(m->obj1->key));
+   }
+}
+
+void exec_delgrp(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_def_out)
+   {
+      write_line(vcd_def_fd, "$upscope $end\n");
+   }
+}
+
+void exec_activate(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+      if(m->obj1->status != RT_OBJECT_RUN)
+      {
+         write_line(msc_fd, "\\regionstart{activation}{%x}\n", m->obj1->uid);
+         svg_region_start(m->obj1, SVG_REGION_ACTIVATION);
+      }
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_out)
+   {
+      if(m->obj1->status != RT_OBJECT_RUN)
+         write_scalar(vcd_fd, '1', '^', m->obj1, 1);
+   }
+   m->obj1->status = RT_OBJECT_RUN;
+}
+
+void exec_acquire(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+      write_line(msc_fd, "\\mess*{acquire}{%x}{%x}\n", m->obj1->uid, m->obj2->uid);
+      svg_mess("acquire", m->obj1, m->obj2, 0, 1);
+
+      if(m->obj1->status != RT_OBJECT_RUN)
+      {
+         write_line(msc_fd, "\\regionstart{activation}{%x}\n", m->obj1->uid);
+         svg_region_start(m->obj1, SVG_REGION_ACTIVATION);
+      }
+
+      if(m->obj2->status != RT_OBJECT_READY)
+      {
+         write_line(msc_fd, "\\regionend{%x}\n", m->obj2->uid);
+         svg_region_end(m->obj2);
+      }
+   }
+   if(sdl_out)
+   {
+   }
+   if(vcd_out)
+   {
+      if(m->obj1->status != RT_OBJECT_RUN)
+         write_scalar(vcd_fd, '1', '^', m->obj1, 0);
+
+      if(m->obj2->status != RT_OBJECT_READY)
+         write_scalar(vcd_fd, '0', '^', m->obj2, 0);
+   }
+   m->obj1->status = RT_OBJECT_RUN;
+   m->obj2->status = RT_OBJECT_READY;
+}
+
+void exec_declevent(struct rt_msg * m)
+{
+   m->obj1->quantification = 1;
+   if(msc_out)
+   {
+   }
+   if(vcd_def_out)
+   {
+      write_line(vcd_def_fd, "$var event 1 !%x %s $end\n", m->obj1, text_str(m->obj1->key));
+   }
+   if(sdl_out)
+   {
+   }
+}
+
+void exec_decltime(struct rt_msg * m)
+{
+   m->obj1->quantification = m->id2;
+   if(msc_out)
+   {
+   }
+   if(vcd_def_out)
+   {
+      write_line(vcd_def_fd, "$var time %d @%x %s $end\n", m->id2, m->obj1, text_str(m->obj1->key));
+   }
+   if(sdl_out)
+   {
+   }
+}
+
+void exec_declparam(struct rt_msg * m)
+{
+   m->obj1->quantification = m->id2;
+   if(msc_out)
+   {
+   }
+   if(vcd_def_out)
+   {
+      write_line(vcd_def_fd, "$var parameter %d @%x %s $end\n", m->id2, m->obj1, text_str(m->obj1->key));
+   }
+   if(sdl_out)
+   {
+   }
+}
+
+void exec_declreg(struct rt_msg * m)
+{
+   m->obj1->quantification = m->id2;
+   if(msc_out)
+   {
+   }
+   if(vcd_def_out)
+   {
+      write_line(vcd_def_fd, "$var reg %d @%x %s $end\n", m->id2, m->obj1, text_str(m->obj1->key));
+   }
+   if(sdl_out)
+   {
+   }
+}
+
+void exec_setevent(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+   }
+   if(vcd_out)
+   {
+      write_line(vcd_fd, "%d!%x\n", m->id2, m->obj1);
+   }
+   if(sdl_out)
+   {
+   }
+   m->obj1->value = m->id2;
+}
+
+void exec_setparam(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+   }
+   if(vcd_out)
+   {
+      char bin[32];
+      to_binary(m->id2, bin);
+      write_line(vcd_fd, "b%s @%x\n", bin, m->obj1);
+   }
+   if(sdl_out)
+   {
+   }
+   m->obj1->value = m->id2;
+}
+
+void exec_setreg(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+   }
+   if(vcd_out)
+   {
+      char bin[32];
+      to_binary(m->id2, bin);
+      write_line(vcd_fd, "b%s @%x\n", bin, m->obj1);
+   }
+   if(sdl_out)
+   {
+   }
+   m->obj1->value = m->id2;
+}
+
+void exec_settime(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+   }
+   if(vcd_out)
+   {
+      char bin[32];
+      to_binary(m->id2, bin);
+      write_line(vcd_fd, "b%s @%x\n", bin, m->obj1);
+   }
+   if(sdl_out)
+   {
+   }
+   m->obj1->value = m->id2;
+}
+
+void exec_setbool(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+   }
+   if(vcd_out)
+   {
+      write_line(vcd_fd, "%d&%x\n", m->id2, m->obj1);
+   }
+   if(sdl_out)
+   {
+   }
+   m->obj1->value = m->id2;
+}
+
+void exec_setwire(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+   }
+   if(vcd_out)
+   {
+      char bin[32];
+      to_binary(m->id2, bin);
+      write_line(vcd_fd, "b%s @%x\n", bin, m->obj1);
+   }
+   if(sdl_out)
+   {
+   }
+   m->obj1->value = m->id2;
+}
+
+void exec_startdump(struct rt_msg * m)
+{
+   if(msc_output())
+   {
+      if(msc_out == 0)
+      {
+         msc_out   = 1;
+         msc_page  = msc_get_time(m);
+         msc_level = msc_page;
+         msc_dump_start(msc_fd, "msc", m->time);
+      }
+      else
+      {
+         ERROR("msc dumping already activated\n");
+      }
+   }
+   if(vcd_fd > 0)
+   {
+      if(vcd_out == 0)
+      {
+         vcd_out   = 1;
+         vcd_level = vcd_get_time(m);
+         vcd_dump_start(vcd_fd, m->time);
+      }
+      else
+      {
+         ERROR("vcd dumping already activated\n");
+      }
+ 
+   }
+   if(sdl_fd > 0)
+   {
+   }
+}
+
+void exec_stopdump(struct rt_msg * m)
+{
+   if(msc_output())
+   {
+      if(msc_out)
+      {
+         msc_dump_stop(msc_fd, m->time);
+         msc_out = 0;
+      }
+      else
+      {
+         ERROR("msc dumping already deactivated\n");
+      }
+   }
+   if(vcd_fd > 0)
+   {
+      if(vcd_out)
+      {
+         vcd_level = vcd_get_time(m);
+         write_time(vcd_fd, vcd_level);
+         vcd_out = 0;
+      }
+      else
+      {
+         ERROR("vcd dumping already deactivated\n");
+      }
+   }
+   if(sdl_fd > 0)
+   {
+   }
+}
+
+void exec_delvar(struct rt_msg * m)
+{
+   if(msc_out)
+   {
+   }
+   if(vcd_out)
+   {
+      switch(m->obj1->type)
+      {
+         case RT_STRING:
+            write_line(vcd_fd, "sUNDEF $%x\n", m->obj1);
+            break;
+         case RT_INT:
+         case RT_REAL:
+            write_line(vcd_fd, "rnan #%x\n", m->obj1);
+            break;
+         case RT_BOOL:
+            write_scalar(vcd_fd, 'x', '&', m->obj1, 0);
+            break;
+         case RT_PARAM:
+         case RT_WIRE:
+         case RT_TIME:
+         case RT_REG:
+            write_line(vcd_fd, "bx @%x\n", m->obj1);
+            break;
+         default:
+            break;
+      }
+   }
+   if(sdl_out)
+   {
+   }
+}
+
+void exec_setglobal(struct rt_msg * m)
+{
+   set_object_global(m->obj1, m->id2);
+
+   if(msc_out)
+   {
+   }
+   if(vcd_out)
+   {
+   }
+   if(sdl_out)
+   {
+   }
+}
+
+/**
+ * Indicate all representations for a command
+ */
+int classify_cmd(rt_cmd_t cmd)
+{
+   int class = 0;
+   switch(cmd)
+   {
+      case RT_DEF_CMD_SETEVENT:
+      case RT_DEF_CMD_SETPARAM:
+      case RT_DEF_CMD_SETREG:
+      case RT_DEF_CMD_SETTIME:
+      case RT_DEF_CMD_SETBOOL:
+      case RT_DEF_CMD_DECLBOOL:
+      case RT_DEF_CMD_DECLWIRE:
+      case RT_DEF_CMD_DECLINT:
+      case RT_DEF_CMD_DECLREAL:
+      case RT_DEF_CMD_DECLSTRING:
+      case RT_DEF_CMD_DECLPARAM:
+      case RT_DEF_CMD_DECLREG:
+      case RT_DEF_CMD_DECLTIME:
+      case RT_DEF_CMD_DECLEVENT:
+      case RT_DEF_CMD_SETINT:
+      case RT_DEF_CMD_SETREAL:
+      case RT_DEF_CMD_SETSTRING:
+      case RT_DEF_CMD_SETWIRE:
+      case RT_DEF_CMD_DELVAR:
+         class = RT_VCD;
+         break;
+      case RT_DEF_CMD_SETSTATE:
+      case RT_DEF_CMD_DECLTASK:
+      case RT_DEF_CMD_DECLMUTEX:
+      case RT_DEF_CMD_DECLOBJ:
+      case RT_DEF_CMD_WAIT:
+      case RT_DEF_CMD_SWITCH:
+      case RT_DEF_CMD_READY:
+      case RT_DEF_CMD_PREEMPT:
+      case RT_DEF_CMD_CREATGRP:
+      case RT_DEF_CMD_DELGRP:
+      case RT_DEF_CMD_RUN:
+      case RT_DEF_CMD_CREATTASK:
+      case RT_DEF_CMD_CREATOBJ:
+      case RT_DEF_CMD_CREATMUTEX:
+      case RT_DEF_CMD_CALL:
+      case RT_DEF_CMD_RETURN:
+      case RT_DEF_CMD_DELMUTEX:
+      case RT_DEF_CMD_DELTASK:
+      case RT_DEF_CMD_DELOBJ:
+      case RT_DEF_CMD_ACQUIRE:
+      case RT_DEF_CMD_SETGLOBAL:
+         class = RT_MSC|RT_VCD;
+         break;
+      case RT_DEF_CMD_COMMENT:
+      case RT_DEF_CMD_SENDMSG:
+      case RT_DEF_CMD_RECVMSG:
+      case RT_DEF_CMD_ACTION:
+      case RT_DEF_CMD_SETTIMER:
+      case RT_DEF_CMD_TIMEOUT:
+      case RT_DEF_CMD_STOPTIMER:
+      case RT_DEF_CMD_TAKE:
+      case RT_DEF_CMD_GIVE:
+         class = RT_MSC;
+         break;
+   }
+
+   return class;
+}
+
+/**
+ * extract from a command what we need to do (new, check or del) on objects for id1 and i2
+ */
+void get_cmd_syntax(struct rt_msg * m,
+                    int           * chk_group,
+                    int           * chk_param1,
+                    int           * chk_param2,
+                    int           * new_param1,
+                    int           * new_param2,
+                    int           * del_param1,
+                    int           * del_param2)
+{
+   *chk_param1 = RT_NONE;
+   *chk_group  = RT_NONE;
+   *chk_param2 = RT_NONE;
+   *new_param1 = RT_NONE;
+   *new_param2 = RT_NONE;
+   *del_param1 = RT_NONE;
+   *del_param2 = RT_NONE;
+
+   switch(m->cmd)
+   {
+      case RT_DEF_CMD_DECLTASK:
+         *new_param1 = RT_TASK;
+         *chk_group  = RT_GROUP;
+         break;
+      case RT_DEF_CMD_DECLMUTEX:
+         *new_param1 = RT_MUTEX;
+         *chk_group  = RT_GROUP;
+         break;
+      case RT_DEF_CMD_DECLOBJ:
+         *new_param1 = RT_OBJECT;
+         *chk_group  = RT_GROUP;
+         break;
+      case RT_DEF_CMD_SENDMSG:
+         *chk_param1 = RT_TASK;
+         *chk_param2 = RT_TASK;
+         break;
+      case RT_DEF_CMD_CALL:
+         *chk_param1 = RT_TASK|RT_OBJECT;
+         *chk_param2 = RT_TASK|RT_OBJECT;
+         break;
+      case RT_DEF_CMD_RECVMSG:
+         *chk_param1 = RT_TASK;
+         *chk_param2 = RT_TASK;
+         break;
+      case RT_DEF_CMD_WAIT:
+         *chk_param1 = RT_TASK;
+         break;
+      case RT_DEF_CMD_SWITCH:
+         *chk_param1 = RT_TASK;
+         *chk_param2 = RT_TASK;
+         break;
+      case RT_DEF_CMD_RETURN:
+         *chk_param1 = RT_TASK|RT_OBJECT|RT_MUTEX;
+         *chk_param2 = RT_TASK|RT_OBJECT;
+         break;
+      case RT_DEF_CMD_COMMENT:
+         *chk_param1 = RT_TASK|RT_OBJECT|RT_MUTEX;
+         break;
+      case RT_DEF_CMD_ACTION:
+         *chk_param1 = RT_TASK|RT_OBJECT|RT_MUTEX;
+         break;
+      case RT_DEF_CMD_SETTIMER:
+         *chk_param1 = RT_TASK|RT_OBJECT|RT_MUTEX;
+         break;
+      case RT_DEF_CMD_TIMEOUT:
+         *chk_param1 = RT_TASK|RT_OBJECT|RT_MUTEX;
+         break;
+      case RT_DEF_CMD_STOPTIMER:
+         *chk_param1 = RT_TASK|RT_OBJECT|RT_MUTEX;
+         break;
+      case RT_DEF_CMD_READY:
+         *chk_param1 = RT_TASK|RT_OBJECT|RT_MUTEX;
+         break;
+      case RT_DEF_CMD_PREEMPT:
+         *chk_param1 = RT_TASK|RT_OBJECT|RT_MUTEX;
+         break;
+      case RT_DEF_CMD_CREATTASK:
+         *chk_param1 = RT_TASK|RT_OBJECT;
+         *new_param2 = RT_TASK;
+         *chk_group  = RT_GROUP;
+         break;
+      case RT_DEF_CMD_CREATMUTEX:
+         *chk_param1 = RT_TASK|RT_OBJECT;
+         *new_param2 = RT_MUTEX;
+         *chk_group  = RT_GROUP;
+         break;
+      case RT_DEF_CMD_CREATOBJ:
+         *chk_param1 = RT_TASK|RT_OBJECT;
+         *new_param2 = RT_OBJECT;
+         *chk_group  = RT_GROUP;
+         break;
+      case RT_DEF_CMD_TAKE:
+         *chk_param1 = RT_TASK|RT_OBJECT;
+         *chk_param2 = RT_MUTEX;
+         break;
+      case RT_DEF_CMD_GIVE:
+         *chk_param1 = RT_TASK|RT_OBJECT;
+         *chk_param2 = RT_MUTEX;
+         break;
+      case RT_DEF_CMD_DELMUTEX:
+         *chk_param1 = RT_TASK|RT_OBJECT;
+         *del_param2 = RT_MUTEX;
+         break;
+      case RT_DEF_CMD_DELTASK:
+         *chk_param1 = RT_TASK|RT_OBJECT;
+         *del_param2 = RT_TASK;
+         break;
+      case RT_DEF_CMD_DELOBJ:
+         *chk_param1 = RT_TASK|RT_OBJECT;
+         *del_param2 = RT_OBJECT;
+         break;
+      case RT_DEF_CMD_DECLBOOL:
+         *chk_group  = RT_GROUP;
+         *new_param1 = RT_BOOL;
+         break;
+      case RT_DEF_CMD_DECLWIRE:
+         *chk_group  = RT_GROUP;
+         *new_param1 = RT_WIRE;
+         break;
+      case RT_DEF_CMD_DECLINT:
+         *chk_group  = RT_GROUP;
+         *new_param1 = RT_INT;
+         break;
+      case RT_DEF_CMD_DECLREAL:
+         *new_param1 = RT_REAL;
+         *chk_group  = RT_GROUP;
+         break;
+      case RT_DEF_CMD_DECLSTRING:
+         *new_param1 = RT_STRING;
+         *chk_group  = RT_GROUP;
+         break;
+      case RT_DEF_CMD_DECLPARAM:
+         *new_param1 = RT_PARAM;
+         *chk_group  = RT_GROUP;
+         break;
+      case RT_DEF_CMD_DECLREG:
+         *new_param1 = RT_REG;
+         *chk_group  = RT_GROUP;
+         break;
+      case RT_DEF_CMD_DECLTIME:
+         *new_param1 = RT_TIME;
+         *chk_group  = RT_GROUP;
+         break;
+      case RT_DEF_CMD_DECLEVENT:
+         *chk_group  = RT_GROUP;
+         *new_param1 = RT_EVENT;
+         break;
+      case RT_DEF_CMD_SETSTATE:
+         *chk_param1 = RT_TASK|RT_OBJECT;
+         break;
+      case RT_DEF_CMD_SETINT:
+         *chk_param1 = RT_INT;
+         break;
+      case RT_DEF_CMD_SETREAL:
+         *chk_param1 = RT_REAL;
+         break;
+      case RT_DEF_CMD_SETREG:
+         *chk_param1 = RT_REG;
+         break;
+      case RT_DEF_CMD_SETPARAM:
+         *chk_param1 = RT_PARAM;
+         break;
+      case RT_DEF_CMD_SETBOOL:
+         *chk_param1 = RT_BOOL;
+         break;
+      case RT_DEF_CMD_SETWIRE:
+         *chk_param1 = RT_WIRE;
+         break;
+      case RT_DEF_CMD_SETEVENT:
+         *chk_param1 = RT_EVENT;
+         break;
+      case RT_DEF_CMD_SETSTRING:
+         *chk_param1 = RT_STRING;
+         break;
+      case RT_DEF_CMD_SETTIME:
+         *chk_param1 = RT_TIME;
+         break;
+      case RT_DEF_CMD_CREATGRP:
+         *chk_group  = RT_GROUP;
+         *new_param1 = RT_GROUP;
+         break;
+      case RT_DEF_CMD_DELGRP:
+         *del_param1 = RT_GROUP;
+         break;
+      case RT_DEF_CMD_RUN:
+         *chk_param1 = RT_TASK|RT_OBJECT|RT_MUTEX;
+         break;
+      case RT_DEF_CMD_ACQUIRE:
+         *chk_param1 = RT_MUTEX;
+         *chk_param2 = RT_TASK|RT_OBJECT;
+         break;
+      case RT_DEF_CMD_DELVAR:
+         *del_param1 = RT_REAL|RT_REG|RT_PARAM|RT_WIRE|RT_BOOL|RT_TIME|RT_EVENT|RT_STRING|RT_INT;
+         break;
+      case RT_DEF_CMD_SETGLOBAL:
+         *chk_param1 = RT_TASK|RT_OBJECT|RT_MUTEX|RT_REAL|RT_REG|RT_PARAM|RT_WIRE|RT_BOOL|RT_TIME|RT_EVENT|RT_STRING|RT_INT;
+         break;
+   }
+
+   /* objects that need to be deleted must be checked before exec_cmd */
+   *chk_param1 |= *del_param1;
+   *chk_param2 |= *del_param2;
+}
+
+/**
+ * alloc needed objects depending on parameters
+ */
+int alloc_params(struct rt_msg * m, int new_param1, int new_param2)
+{
+   if(new_param1 != RT_NONE)
+   {
+      m->obj1 = add_object(m->fid, m->id1, new_param1, m->group, m->text);
+      if (m->obj1 == NULL)
+         return -1;
+   }
+
+   if(new_param2 != RT_NONE)
+   {
+      m->obj2 = add_object(m->fid, m->id2, new_param2, m->group, m->text);
+      if (m->obj2 == NULL)
+         return -1;
+   }
+   return 0;
+}
+
+
+/**
+ * check object references depending on parameters
+ */
+int check_params(struct rt_msg * m, int chk_group, int chk_param1, int chk_param2)
+{
+   if(chk_group != RT_NONE) // group zero corresponds to the implicit 'top', so is accepted
+   {
+      m->group = find_object(m->fid, m->gid); // allow seraching globally if locally not found
+      if(m->group == NULL)
+      {
+         ERROR("Bad group reference : cmd '%s' at @%d\n", rt_cmd_name(m->cmd), m->time);
+         return -1;
+      }
+      if((m->group->type & chk_group) != m->group->type)
+      {
+         ERROR("Bad group type : cmd '%s' at @%d as invalid type %s\n", rt_cmd_name(m->cmd), m->time, rt_type_name(m->group->type));
+         print_msg(m);
+         return -1;
+      }
+      VERB("ref object '%s' fid=%x oid %x\n", text_str(m->group->name), m->group->fid, m->group->oid);
+   }
+
+   if(chk_param1 != RT_NONE)
+   {
+      m->obj1 = find_object(m->fid, m->id1); // allow seraching globally if locally not found
+      if(m->obj1 == NULL)
+      {
+         ERROR("Bad identifier1 reference %x : cmd '%s' at @%d\n", m->id1, rt_cmd_name(m->cmd), m->time);
+         return -1;
+      }
+      if((m->obj1->type & chk_param1) != m->obj1->type)
+      {
+         ERROR("Bad identifier1 type : cmd '%s' at @%d as invalid type %s\n", rt_cmd_name(m->cmd), m->time, rt_type_name(m->obj1->type));
+         print_msg(m);
+         return -1;
+      }
+      VERB("ref object '%s' fid=%x oid %x\n", text_str(m->obj1->name), m->obj1->fid, m->obj1->oid);
+   }
+
+   if(chk_param2 != RT_NONE)
+   {
+      m->obj2 = find_object(m->fid, m->id2); // allow seraching globally if locally not found
+      if(m->obj2 == NULL)
+      {
+         ERROR("Bad identifier2 reference %x : cmd '%s' at @%d\n", m->id2, rt_cmd_name(m->cmd), m->time);
+         return -1;
+      }
+      if((m->obj2->type & chk_param2) != m->obj2->type)
+      {
+         ERROR("Bad identifier2 type : cmd '%s' at @%d as invalid type %s\n", rt_cmd_name(m->cmd), m->time, rt_type_name(m->obj2->type));
+         return -1;
+      }
+      VERB("ref object '%s' fid=%x oid %x\n", text_str(m->obj2->name), m->obj2->fid, m->obj2->oid);
+   }
+   return 0;
+}
+
+
+/**
+ * remove objects depending on parameters
+ * if object is not vcd, it can be removed immediately. For vcd files, we cannot remove the
+ * objects until the vcd definition phasis is finished.
+ */
+int free_params(struct rt_msg * m, int del_param1, int del_param2)
+{
+   if(del_param1 != RT_NONE)
+   {
+      if(del_object_by_id(m->fid, m->id1, 1) < 0)
+         return -1;
+   }
+
+   if(del_param2 != RT_NONE)
+   {
+      if(del_object_by_id(m->fid, m->id2, 1) < 0)
+         return -1;
+   }
+   return 0;
+}
+
+
+/**
+ * a new command as been sorted and is ready to be executed
+ */
+void exec_cmd(struct rt_msg * m)
+{
+   switch(m->cmd)
    {
       case RT_DEF_CMD_DECLTASK:
-         *new_param1 = RT_TASK;
-         *chk_group  = RT_GROUP;
+         exec_decltask(m);
          break;
       case RT_DEF_CMD_DECLMUTEX:
-         *new_param1 = RT_MUTEX;
-         *chk_group  = RT_GROUP;
+         exec_declmutex(m);
          break;
       case RT_DEF_CMD_DECLOBJ:
-         *new_param1 = RT_OBJECT;
-         *chk_group  = RT_GROUP;
+         exec_declobj(m);
          break;
       case RT_DEF_CMD_SENDMSG:
-         *chk_param1 = RT_TASK;
-         *chk_param2 = RT_TASK;
+         exec_sendmsg(m);
          break;
       case RT_DEF_CMD_CALL:
-         *chk_param1 = RT_TASK|RT_OBJECT;
-         *chk_param2 = RT_TASK|RT_OBJECT;
+         exec_call(m);
          break;
       case RT_DEF_CMD_RECVMSG:
-         *chk_param1 = RT_TASK;
-         *chk_param2 = RT_TASK;
+         exec_recvmsg(m);
          break;
       case RT_DEF_CMD_WAIT:
-         *chk_param1 = RT_TASK;
+         exec_sleep(m);
          break;
       case RT_DEF_CMD_SWITCH:
-         *chk_param1 = RT_TASK;
-         *chk_param2 = RT_TASK;
+         exec_switch(m);
          break;
       case RT_DEF_CMD_RETURN:
-         *chk_param1 = RT_TASK|RT_OBJECT|RT_MUTEX;
-         *chk_param2 = RT_TASK|RT_OBJECT;
+         exec_return(m);
          break;
       case RT_DEF_CMD_COMMENT:
-         *chk_param1 = RT_TASK|RT_OBJECT|RT_MUTEX;
+         exec_comment(m);
          break;
       case RT_DEF_CMD_ACTION:
-         *chk_param1 = RT_TASK|RT_OBJECT|RT_MUTEX;
+         exec_action(m);
          break;
       case RT_DEF_CMD_SETTIMER:
-         *chk_param1 = RT_TASK|RT_OBJECT|RT_MUTEX;
+         exec_settimer(m);
          break;
       case RT_DEF_CMD_TIMEOUT:
-         *chk_param1 = RT_TASK|RT_OBJECT|RT_MUTEX;
+         exec_exptimer(m);
          break;
       case RT_DEF_CMD_STOPTIMER:
-         *chk_param1 = RT_TASK|RT_OBJECT|RT_MUTEX;
+         exec_stoptimer(m);
          break;
       case RT_DEF_CMD_READY:
-         *chk_param1 = RT_TASK|RT_OBJECT|RT_MUTEX;
+         exec_ready(m);
          break;
       case RT_DEF_CMD_PREEMPT:
-         *chk_param1 = RT_TASK|RT_OBJECT|RT_MUTEX;
+         exec_suspend(m);
          break;
       case RT_DEF_CMD_CREATTASK:
-         *chk_param1 = RT_TASK|RT_OBJECT;
-         *new_param2 = RT_TASK;
-         *chk_group  = RT_GROUP;
+         exec_creattask(m);
          break;
       case RT_DEF_CMD_CREATMUTEX:
-         *chk_param1 = RT_TASK|RT_OBJECT;
-         *new_param2 = RT_MUTEX;
-         *chk_group  = RT_GROUP;
+         exec_creatmutex(m);
          break;
       case RT_DEF_CMD_CREATOBJ:
-         *chk_param1 = RT_TASK|RT_OBJECT;
-         *new_param2 = RT_OBJECT;
-         *chk_group  = RT_GROUP;
+         exec_creatobj(m);
          break;
       case RT_DEF_CMD_TAKE:
-         *chk_param1 = RT_TASK|RT_OBJECT;
-         *chk_param2 = RT_MUTEX;
+         exec_take(m);
          break;
       case RT_DEF_CMD_GIVE:
-         *chk_param1 = RT_TASK|RT_OBJECT;
-         *chk_param2 = RT_MUTEX;
+         exec_give(m);
          break;
       case RT_DEF_CMD_DELMUTEX:
-         *chk_param1 = RT_TASK|RT_OBJECT;
-         *del_param2 = RT_MUTEX;
+         exec_delmutex(m);
          break;
       case RT_DEF_CMD_DELTASK:
-         *chk_param1 = RT_TASK|RT_OBJECT;
-         *del_param2 = RT_TASK;
+         exec_deltask(m);
          break;
       case RT_DEF_CMD_DELOBJ:
-         *chk_param1 = RT_TASK|RT_OBJECT;
-         *del_param2 = RT_OBJECT;
+         exec_delobj(m);
          break;
       case RT_DEF_CMD_DECLBOOL:
-         *chk_group  = RT_GROUP;
-         *new_param1 = RT_BOOL;
+         exec_declbool(m);
          break;
       case RT_DEF_CMD_DECLWIRE:
-         *chk_group  = RT_GROUP;
-         *new_param1 = RT_WIRE;
+         exec_declwire(m);
          break;
       case RT_DEF_CMD_DECLINT:
-         *chk_group  = RT_GROUP;
-         *new_param1 = RT_INT;
+         exec_declint(m);
          break;
       case RT_DEF_CMD_DECLREAL:
-         *new_param1 = RT_REAL;
-         *chk_group  = RT_GROUP;
+         exec_declreal(m);
          break;
       case RT_DEF_CMD_DECLSTRING:
-         *new_param1 = RT_STRING;
-         *chk_group  = RT_GROUP;
-         break;
-      case RT_DEF_CMD_DECLPARAM:
-         *new_param1 = RT_PARAM;
-         *chk_group  = RT_GROUP;
+         exec_declstring(m);
          break;
-      case RT_DEF_CMD_DECLREG:
-         *new_param1 = RT_REG;
-         *chk_group  = RT_GROUP;
+      case RT_DEF_CMD_SETINT:
+         exec_setint(m);
          break;
-      case RT_DEF_CMD_DECLTIME:
-         *new_param1 = RT_TIME;
-         *chk_group  = RT_GROUP;
+      case RT_DEF_CMD_SETREAL:
+         exec_setreal(m);
          break;
-      case RT_DEF_CMD_DECLEVENT:
-         *chk_group  = RT_GROUP;
-         *new_param1 = RT_EVENT;
+      case RT_DEF_CMD_SETSTRING:
+         exec_setstring(m);
          break;
       case RT_DEF_CMD_SETSTATE:
-         *chk_param1 = RT_TASK|RT_OBJECT;
+         exec_setstate(m);
          break;
-      case RT_DEF_CMD_SETINT:
-         *chk_param1 = RT_INT;
+      case RT_DEF_CMD_CREATGRP:
+         exec_creategrp(m);
          break;
-      case RT_DEF_CMD_SETREAL:
-         *chk_param1 = RT_REAL;
+      case RT_DEF_CMD_DELGRP:
+         exec_delgrp(m);
          break;
-      case RT_DEF_CMD_SETREG:
-         *chk_param1 = RT_REG;
+      case RT_DEF_CMD_RUN:
+         exec_activate(m);
          break;
-      case RT_DEF_CMD_SETPARAM:
-         *chk_param1 = RT_PARAM;
+      case RT_DEF_CMD_ACQUIRE:
+         exec_acquire(m);
          break;
-      case RT_DEF_CMD_SETBOOL:
-         *chk_param1 = RT_BOOL;
+      case RT_DEF_CMD_DECLEVENT:
+         exec_declevent(m);
          break;
-      case RT_DEF_CMD_SETWIRE:
-         *chk_param1 = RT_WIRE;
+      case RT_DEF_CMD_DECLTIME:
+         exec_decltime(m);
+         break;
+      case RT_DEF_CMD_DECLPARAM:
+         exec_declparam(m);
+         break;
+      case RT_DEF_CMD_DECLREG:
+         exec_declreg(m);
          break;
       case RT_DEF_CMD_SETEVENT:
-         *chk_param1 = RT_EVENT;
+         exec_setevent(m);
          break;
-      case RT_DEF_CMD_SETSTRING:
-         *chk_param1 = RT_STRING;
+      case RT_DEF_CMD_SETPARAM:
+         exec_setparam(m);
+         break;
+      case RT_DEF_CMD_SETREG:
+         exec_setreg(m);
          break;
       case RT_DEF_CMD_SETTIME:
-         *chk_param1 = RT_TIME;
+         exec_settime(m);
          break;
-      case RT_DEF_CMD_CREATGRP:
-         *chk_group  = RT_GROUP;
-         *new_param1 = RT_GROUP;
+      case RT_DEF_CMD_SETBOOL:
+         exec_setbool(m);
          break;
-      case RT_DEF_CMD_DELGRP:
-         *del_param1 = RT_GROUP;
+      case RT_DEF_CMD_SETWIRE:
+         exec_setwire(m);
          break;
-      case RT_DEF_CMD_RUN:
-         *chk_param1 = RT_TASK|RT_OBJECT|RT_MUTEX;
+      case RT_DEF_CMD_STARTDUMP:
+         exec_startdump(m);
          break;
-      case RT_DEF_CMD_ACQUIRE:
-         *chk_param1 = RT_MUTEX;
-         *chk_param2 = RT_TASK|RT_OBJECT;
+      case RT_DEF_CMD_STOPDUMP:
+         exec_stopdump(m);
+         break;
+      case RT_DEF_CMD_DELVAR:
+         exec_delvar(m);
+         break;
+      case RT_DEF_CMD_SETGLOBAL:
+         exec_setglobal(m);
+         break;
+
+   }
+}
+
+/**
+ * some stuf to do before executing any message
+ * return 0 is the command can be exectued
+ * return -1 else
+ */
+int process_cmd(struct rt_msg * m)
+{
+   int chk_group, chk_param1, chk_param2, new_param1, new_param2, del_param1, del_param2;
+   rt_time_t off;
+
+#if DEBUG(INFO)
+   INFO_OPT(LOG_HAVE_NEXT                , "exe_cmd %-15s", rt_cmd_name(m->cmd));
+   INFO_OPT(LOG_HAVE_NEXT | LOG_HAVE_PREV, " time %10d", m->time);
+   INFO_OPT(LOG_HAVE_NEXT | LOG_HAVE_PREV, " fid  %8x", m->fid);
+   INFO_OPT(LOG_HAVE_NEXT | LOG_HAVE_PREV, " gid  %8x", m->gid);
+   INFO_OPT(LOG_HAVE_NEXT | LOG_HAVE_PREV, " id1  %8x", m->id1);
+   INFO_OPT(LOG_HAVE_NEXT | LOG_HAVE_PREV, " id2  %8x", m->id2);
+   INFO_OPT(                LOG_HAVE_PREV, " text '%s'\n", m->text);
+#endif
+   // msc check cmd
+   if(m->class & RT_MSC)
+   {
+      // find a correlation for this message
+      if(msc_out)
+         msc_find_corr(m);
+
+      // a repeated event is counted in its run instead of being drawn
+      if(msc_aggregate && msc_out && !m->aggr)
+         msc_aggr_check(m);
+
+      /*
+       * VERB("cmd_pre '%s' : time=%d off=%d msc_page=%d msc_page_max_levels=%d msc_level=%d\n",
+       *      rt_cmd_name(m->cmd), msc_get_time(m), m->off, msc_page, msc_page_max_levels, msc_level);
+       */
+
+      if(m->aggr)
+      {
+         // an aggregated event takes no level, unless a drawn message crosses it
+         if(!msc_in_flight && (msc_get_time(m) > msc_level))
+            msc_aggr_shift += msc_get_time(m) - msc_level;
+      }
+      // current level update
+      else if (msc_get_time(m) > msc_level)
+      {
+         rt_time_t gap = 0;
+
+         // collapse a long idle span into one level, instead of empty levels and pages
+         if(msc_gap && !msc_untimed && (msc_get_time(m) - msc_level > (rt_time_t)msc_gap))
+         {
+            gap = msc_get_time(m) - msc_level - 1;
+            msc_gap_shift += gap;
+            msc_gap_count++;
+         }
+
+         if(msc_out)
+         {
+            int saved_vcd = vcd_out;
+            int saved_sdl = sdl_out;
+
+            // during a page break, disable write accesses to other files
+            vcd_out = 0;
+            sdl_out = 0;
+
+            // break the page each time m->time() - msc_page > msc_page_max_levels
+            while (msc_get_time(m) - msc_page >= msc_page_max_levels)
+            {
+               // compute nextlevel to terminate the page. current msc_level is supposed to be
+               // inside a normal page
+               off = msc_page_max_levels - (msc_level - msc_page);
+               write_line(msc_fd, "\\nextlevel[%d]\n", off);
+               svg_nextlevel(off);
+               msc_level += off;
+               write_line(msc_fd, "%%level=%d\n", msc_level);
+
+               // start a new page
+               msc_page = msc_level;
+
+               // start a new page
+               msc_dump_stop(msc_fd, m->time);
+
+               // with workers, full units are compiled while the simulation goes on
+               if(msc_jobs && (msc_unit_pages >= msc_batch))
+               {
+                  msc_unit_close();
+                  msc_unit_open();
+               }
+               else
+               {
+                  write_line(msc_fd, "\\newpage\n");
+               }
+               sink_flush_all();
+               msc_dump_start(msc_fd, "msc", m->time);
+            }
+
+            // restore file descriptors
+            vcd_out = saved_vcd;
+            sdl_out = saved_sdl;
+
+            // update next level
+            write_line(msc_fd, "\\nextlevel[%d]\n", msc_get_time(m) - msc_level);
+            svg_nextlevel(msc_get_time(m) - msc_level);
+
+         }
+
+         // set new time
+         msc_level = msc_get_time(m);
+
+         if(msc_out)
+         {
+            // add a comment
+            write_line(msc_fd, "%%level=%d\n", msc_level);
+            if(msc_mark_grain == MSC_MARK_GRANULARITY_LEVEL)
+               msc_mark(msc_fd, "bl", m->time);
+            if(gap)
+               msc_gap_mark(msc_fd, gap);
+         }
+      }
+      else if (msc_get_time(m) < msc_level)
+      {
+         ERROR("old message '%s' at @%d\n", rt_cmd_name(m->cmd), m->time);
+         return -1;
+      }
+
+      // break correlation if a newpage is between, or if the message may cross a collapsed span
+      if (msc_out && m->corr && !m->aggr && ((msc_get_time(m) + m->off - msc_page >= msc_page_max_levels) ||
+                                 (msc_gap && !msc_untimed && ((int)m->off > msc_gap))))
+      {
+         // the correlated message, if still queued, is not correlated anymore
+         if(m->corr_event)
+            m->corr_event->flags &= ~RT_EVENT_CORR;
+         m->corr       = 0;
+         m->corr_event = NULL;
+         VERB("break correlation\n");
+      }
+   }
+
+   // vcd check cmd
+   if(m->class & RT_VCD)
+   {
+      if (vcd_get_time(m) > vcd_level)
+      {
+         // set new time
+         vcd_level = vcd_get_time(m);
+
+         if ((vcd_level > 0) && vcd_out)
+            write_time(vcd_fd, vcd_level);
+      }
+      else if (vcd_get_time(m) < vcd_level)
+      {
+         ERROR("old message '%s' at @%d\n", rt_cmd_name(m->cmd), m->time);
+         return -1;
+      }
+   }
+
+   // see how the command behave with its objects
+   get_cmd_syntax(m, &chk_group, &chk_param1, &chk_param2, &new_param1, &new_param2, &del_param1, &del_param2);
+
+   // in vcd fifo mode all symbols must be declared at the beginning of the vcd dump file
+   if((m->class & RT_VCD) && vcd_fifo)
+   {
+      int sym_def = (new_param1 | new_param2);
+
+      // the value change dump section starts when time is > 0 or when detection something else than a symbol definition
+      if(!vcd_def_end && ((vcd_get_time(m) > 0) || !sym_def))
+      {
+         vcd_write_definitions();
+         vcd_def_end = 1;
+
+         // the zombies are not needed anymore by vcd definitions
+         compact_zombies();
+      }
+      else if(vcd_def_end && sym_def)
+      {
+         ERROR("vcd_fifo mode forbid declaration of symbols after definition phasis : cmd '%s' at @%d\n", rt_cmd_name(m->cmd), m->time);
+         return -1;
+      }
+   }
+
+   // check for correct parameter references, and link message to objects
+   if(check_params(m, chk_group, chk_param1, chk_param2))
+      return -1;
+
+   // allocate new objects and link them to obj1 or obj2
+   if(alloc_params(m, new_param1, new_param2))
+      return -1;
+
+   // with a page buffer, the instances of the message are shown on the current page
+   if((m->class & RT_MSC) && msc_out && !m->aggr)
+   {
+      msc_use(m->obj1);
+      msc_use(m->obj2);
+   }
+
+   // the runs of an instance end before a drawn event of it that does not belong to them, so that only
+   // consecutive repeats are aggregated
+   if(msc_aggregate && (m->class & RT_MSC) && msc_out && !m->aggr)
+      msc_aggr_end(m);
+
+   // the runs of a deleted instance end before it
+   if(msc_aggregate && (del_param1 || del_param2))
+   {
+      if(del_param1)
+         msc_aggr_close(m->obj1);
+      if(del_param2)
+         msc_aggr_close(m->obj2);
+   }
+
+   // execute the command. An aggregated event is not drawn
+   if(m->aggr)
+   {
+      int saved_msc = msc_out;
+
+      msc_out = 0;
+      exec_cmd(m);
+      msc_out = saved_msc;
+   }
+   else
+   {
+      exec_cmd(m);
+      if(msc_aggregate && (m->class & RT_MSC))
+         msc_aggr_update(m);
+   }
+
+   // free the objects that are no more necessary
+   if(free_params(m, del_param1, del_param2))
+      return -1;
+
+   return 0;
+}
+
+
+/**
+ * Return 1 if no message is queued
+ */
+int queue_empty()
+{
+   if(rt_queue_algo == RT_QUEUE_HEAP)
+      return rt_heap_count == 0;
+   else
+      return rt_list_count == 0;
+}
+
+/**
+ * Return the oldest queued message
+ */
+struct rt_event * queue_first()
+{
+   if(rt_queue_algo == RT_QUEUE_HEAP)
+      return rt_heap[0];
+   else
+      return rt_list[rt_list_head];
+}
+
+/**
+ * move a heap entry up to its place
+ */
+static void heap_sift_up(int i)
+{
+   struct rt_event * m = rt_heap[i];
+
+   while(i > 0)
+   {
+      int parent = (i - 1) / 2;
+      if(!msg_before(m, rt_heap[parent]))
          break;
-      case RT_DEF_CMD_DELVAR:
-         *del_param1 = RT_REAL|RT_REG|RT_PARAM|RT_WIRE|RT_BOOL|RT_TIME|RT_EVENT|RT_STRING|RT_INT;
+      rt_heap[i] = rt_heap[parent];
+      i = parent;
+   }
+   rt_heap[i] = m;
+}
+
+/**
+ * move a heap entry down to its place
+ */
+static void heap_sift_down(int i)
+{
+   struct rt_event * m = rt_heap[i];
+
+   while(1)
+   {
+      int child = 2 * i + 1;
+      if(child >= rt_heap_count)
          break;
-      case RT_DEF_CMD_SETGLOBAL:
-         *chk_param1 = RT_TASK|RT_OBJECT|RT_MUTEX|RT_REAL|RT_REG|RT_PARAM|RT_WIRE|RT_BOOL|RT_TIME|RT_EVENT|RT_STRING|RT_INT;
+      if((child + 1 < rt_heap_count) && msg_before(rt_heap[child + 1], rt_heap[child]))
+         child++;
+      if(!msg_before(rt_heap[child], m))
          break;
+      rt_heap[i] = rt_heap[child];
+      i = child;
+   }
+   rt_heap[i] = m;
+}
+
+/**
+ * make room at the end of the sorted array, by moving its messages to the beginning of the array,
+ * or by growing it.
+ * return -1 if memory is missing, 0 otherwise
+ */
+static int list_reserve()
+{
+   if(rt_list_head + rt_list_count < rt_list_max)
+      return 0;
+
+   if(rt_list_head > rt_list_max / 2)
+   {
+      mem_move(rt_list, rt_list + rt_list_head, rt_list_count * sizeof(struct rt_event *));
+      rt_list_head = 0;
+   }
+   else
+   {
+      int max = rt_list_max ? 2 * rt_list_max : 1024;
+      struct rt_event ** list = (struct rt_event **)heap_realloc(rt_list, max * sizeof(struct rt_event *));
+      if(list == NULL)
+         return -1;
+      rt_list     = list;
+      rt_list_max = max;
+   }
+   return 0;
+}
+
+/**
+ * return the index of the first untimed slot whose time is not before t, or after t if strict is set
+ */
+static int slot_bound(rt_time_t t, int strict)
+{
+   int lo = untimed_slots_head;
+   int hi = untimed_slots_head + untimed_slots_count;
+
+   while(lo < hi)
+   {
+      int mid = lo + (hi - lo) / 2;
+      if((untimed_slots[mid].time < t) || (strict && (untimed_slots[mid].time == t)))
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+   return lo;
+}
+
+/**
+ * add d to the ranks of the untimed slots, from slot i to the newest one
+ */
+static void slot_shift(int i, int d)
+{
+   for(; i < untimed_slots_head + untimed_slots_count; i++)
+      untimed_slots[i].rank += d;
+}
+
+/**
+ * make room for one more untimed slot, the same way as list_reserve
+ * return -1 if memory is missing, 0 otherwise
+ */
+static int slot_reserve()
+{
+   if(untimed_slots_head + untimed_slots_count < untimed_slots_max)
+      return 0;
+
+   if(untimed_slots_head > untimed_slots_max / 2)
+   {
+      mem_move(untimed_slots, untimed_slots + untimed_slots_head, untimed_slots_count * sizeof(struct rt_slot));
+      untimed_slots_head = 0;
+   }
+   else
+   {
+      int max = untimed_slots_max ? 2 * untimed_slots_max : 256;
+      struct rt_slot * slots = (struct rt_slot *)heap_realloc(untimed_slots, max * sizeof(struct rt_slot));
+      if(slots == NULL)
+         return -1;
+      untimed_slots     = slots;
+      untimed_slots_max = max;
+   }
+   return 0;
+}
+
+/**
+ * count a message entering the queue in the slot of its time. Ranks are only shifted after a new slot, or after
+ * a slot whose first message changes of class. Room must have been made by slot_reserve.
+ */
+static void slot_add(struct rt_event * m)
+{
+   int msc = (classify_cmd(m->cmd) & RT_MSC) ? 1 : 0;
+   int i   = slot_bound(m->time, 0);
+   int end = untimed_slots_head + untimed_slots_count;
+   struct rt_slot * s;
+
+   if((i < end) && (untimed_slots[i].time == m->time))
+   {
+      s = &untimed_slots[i];
+      s->count++;
+      if((s->first != NULL) && msg_before(m, s->first))
+      {
+         s->first = m;
+         if(s->msc != msc)
+         {
+            slot_shift(i, msc - s->msc);
+            s->msc = msc;
+         }
+      }
+      return;
+   }
+
+   /* slots are added from the newest ones (most probable) */
+   if((i == untimed_slots_head) && (untimed_slots_head > 0))
+   {
+      i = --untimed_slots_head;
+   }
+   else
+   {
+      mem_move(untimed_slots + i + 1, untimed_slots + i, (end - i) * sizeof(struct rt_slot));
+   }
+   untimed_slots_count++;
+
+   s        = &untimed_slots[i];
+   s->time  = m->time;
+   s->count = 1;
+   s->msc   = msc;
+   s->first = m;
+   if(i > untimed_slots_head)
+      s->rank = untimed_slots[i - 1].rank + msc;
+   else if(untimed_slots_count > 1)
+      s->rank = untimed_slots[i + 1].rank - untimed_slots[i + 1].msc + msc;
+   else
+      s->rank = msc;
+   slot_shift(i + 1, msc);
+}
+
+/**
+ * uncount the oldest queued message from the oldest slot. Once a message of its time has been released, the
+ * class of a slot no longer matters.
+ */
+static void slot_remove_first()
+{
+   struct rt_slot * s = &untimed_slots[untimed_slots_head];
+
+   s->first = NULL;
+   if(--s->count == 0)
+   {
+      untimed_slots_head++;
+      if(--untimed_slots_count == 0)
+         untimed_slots_head = 0;
+   }
+}
+
+/**
+ * insert a message in the queue, at its place
+ * return -1 if memory is missing, 0 otherwise
+ */
+int queue_insert(struct rt_event * m)
+{
+   if(msc_untimed && (slot_reserve() < 0))
+      return -1;
+
+   if(queue_empty() || (m->time > rt_queue_newest))
+      rt_queue_newest = m->time;
+
+   if(rt_queue_algo == RT_QUEUE_HEAP)
+   {
+      if(rt_heap_count == rt_heap_max)
+      {
+         int max = rt_heap_max ? 2 * rt_heap_max : 1024;
+         struct rt_event ** heap = (struct rt_event **)heap_realloc(rt_heap, max * sizeof(struct rt_event *));
+         if(heap == NULL)
+            return -1;
+         rt_heap     = heap;
+         rt_heap_max = max;
+      }
+      rt_heap[rt_heap_count++] = m;
+      heap_sift_up(rt_heap_count - 1);
+   }
+   else if((rt_list_count > 0) && (rt_list_head > 0) && msg_before(m, queue_first()))
+   {
+      rt_list[--rt_list_head] = m;
+      rt_list_count++;
+   }
+   else
+   {
+      int i;
+
+      if(list_reserve() < 0)
+         return -1;
+
+      /* msg will be inserted in ascending order, starting from the newest ones (most probable) */
+      i = rt_list_head + rt_list_count;
+      while((i > rt_list_head) && msg_before(m, rt_list[i - 1]))
+      {
+         rt_list[i] = rt_list[i - 1];
+         i--;
+      }
+      rt_list[i] = m;
+      rt_list_count++;
+   }
+
+   if(msc_untimed)
+      slot_add(m);
+   return 0;
+}
+
+/**
+ * remove the oldest message from the queue
+ */
+void queue_remove_first()
+{
+   struct rt_event * m = queue_first();
+
+   if(rt_queue_algo == RT_QUEUE_HEAP)
+   {
+      rt_heap[0] = rt_heap[--rt_heap_count];
+      if(rt_heap_count > 0)
+         heap_sift_down(0);
+   }
+   else
+   {
+      rt_list_head++;
+      if(--rt_list_count == 0)
+         rt_list_head = 0;
    }
-
-   /* objects that need to be deleted must be checked before exec_cmd */
-   *chk_param1 |= *del_param1;
-   *chk_param2 |= *del_param2;
+   if(msc_untimed)
+      slot_remove_first();
+   corr_index_del(m);
 }
 
 /**
- * alloc needed objects depending on parameters
+ * move a live source up to its place in rt_source_heap
  */
-int alloc_params(struct rt_msg * m, int new_param1, int new_param2)
+static void source_sift_up(int i)
 {
-   if(new_param1 != RT_NONE)
+   struct rt_source * src = rt_source_heap[i];
+
+   while(i > 0)
    {
-      m->obj1 = add_object(m->fid, m->id1, new_param1, m->group, m->text);
-      if (m->obj1 == NULL)
-         return -1;
+      int parent = (i - 1) / 2;
+      if(rt_source_heap[parent]->watermark <= src->watermark)
+         break;
+      rt_source_heap[i] = rt_source_heap[parent];
+      rt_source_heap[i]->rank = i;
+      i = parent;
    }
+   rt_source_heap[i] = src;
+   src->rank = i;
+}
 
-   if(new_param2 != RT_NONE)
+/**
+ * move a live source down to its place in rt_source_heap
+ */
+static void source_sift_down(int i)
+{
+   struct rt_source * src = rt_source_heap[i];
+
+   while(1)
    {
-      m->obj2 = add_object(m->fid, m->id2, new_param2, m->group, m->text);
-      if (m->obj2 == NULL)
-         return -1;
+      int child = 2 * i + 1;
+      if(child >= rt_source_count)
+         break;
+      if((child + 1 < rt_source_count) && (rt_source_heap[child + 1]->watermark < rt_source_heap[child]->watermark))
+         child++;
+      if(src->watermark <= rt_source_heap[child]->watermark)
+         break;
+      rt_source_heap[i] = rt_source_heap[child];
+      rt_source_heap[i]->rank = i;
+      i = child;
    }
-   return 0;
+   rt_source_heap[i] = src;
+   src->rank = i;
 }
 
-
 /**
- * check object references depending on parameters
+ * add a source to the open inputs, and watch it if it is read by blocks
+ * return -1 if memory is missing, 0 otherwise
  */
-int check_params(struct rt_msg * m, int chk_group, int chk_param1, int chk_param2)
+int input_add(struct rt_source * src)
 {
-   if(chk_group != RT_NONE) // group zero corresponds to the implicit 'top', so is accepted
+   int i;
+
+   if(rt_input_count == rt_inputs_max)
    {
-      m->group = find_object(m->fid, m->gid); // allow seraching globally if locally not found
-      if(m->group == NULL)
-      {
-         ERROR("Bad group reference : cmd '%s' at @%d\n", rt_cmd_name(m->cmd), m->time);
-         return -1;
-      }
-      if((m->group->type & chk_group) != m->group->type)
-      {
-         ERROR("Bad group type : cmd '%s' at @%d as invalid type %s\n", rt_cmd_name(m->cmd), m->time, rt_type_name(m->group->type));
-         print_msg(m);
+      int max = rt_inputs_max ? 2 * rt_inputs_max : 64;
+      struct rt_source ** inputs = (struct rt_source **)heap_realloc(rt_inputs, max * sizeof(struct rt_source *));
+      if(inputs == NULL)
          return -1;
-      }
-      VERB("ref object '%s' fid=%x oid %x\n", m->group->name, m->group->fid, m->group->oid);
+      rt_inputs     = inputs;
+      rt_inputs_max = max;
    }
 
-   if(chk_param1 != RT_NONE)
+   src->polled = 0;
+   src->ready  = 0;
+
+   // regular files cannot be watched: reading them never blocks
+   if(!src->end)
    {
-      m->obj1 = find_object(m->fid, m->id1); // allow seraching globally if locally not found
-      if(m->obj1 == NULL)
-      {
-         ERROR("Bad identifier1 reference %x : cmd '%s' at @%d\n", m->id1, rt_cmd_name(m->cmd), m->time);
-         return -1;
-      }
-      if((m->obj1->type & chk_param1) != m->obj1->type)
+      struct epoll_event ev;
+
+      ev.events   = EPOLLIN;
+      ev.data.ptr = src;
+      if(epoll_ctl(rt_epoll_fd, EPOLL_CTL_ADD, src->fd, &ev) == 0)
       {
-         ERROR("Bad identifier1 type : cmd '%s' at @%d as invalid type %s\n", rt_cmd_name(m->cmd), m->time, rt_type_name(m->obj1->type));
-         print_msg(m);
-         return -1;
+         src->polled = 1;
+         rt_epoll_count++;
       }
-      VERB("ref object '%s' fid=%x oid %x\n", m->obj1->name, m->obj1->fid, m->obj1->oid);
    }
 
-   if(chk_param2 != RT_NONE)
+   i = rt_input_count++;
+   while((i > 0) && (rt_inputs[i - 1]->fd > src->fd))
    {
-      m->obj2 = find_object(m->fid, m->id2); // allow seraching globally if locally not found
-      if(m->obj2 == NULL)
-      {
-         ERROR("Bad identifier2 reference %x : cmd '%s' at @%d\n", m->id2, rt_cmd_name(m->cmd), m->time);
-         return -1;
-      }
-      if((m->obj2->type & chk_param2) != m->obj2->type)
-      {
-         ERROR("Bad identifier2 type : cmd '%s' at @%d as invalid type %s\n", rt_cmd_name(m->cmd), m->time, rt_type_name(m->obj2->type));
-         return -1;
-      }
-      VERB("ref object '%s' fid=%x oid %x\n", m->obj2->name, m->obj2->fid, m->obj2->oid);
+      rt_inputs[i] = rt_inputs[i - 1];
+      i--;
    }
+   rt_inputs[i] = src;
    return 0;
 }
 
-
 /**
- * remove objects depending on parameters
- * if object is not vcd, it can be removed immediately. For vcd files, we cannot remove the
- * objects until the vcd definition phasis is finished.
+ * remove a source from the open inputs
  */
-int free_params(struct rt_msg * m, int del_param1, int del_param2)
+void input_del(struct rt_source * src)
 {
-   if(del_param1 != RT_NONE)
+   int i;
+
+   for(i = 0; i < rt_input_count; i++)
    {
-      if(del_object_by_id(m->fid, m->id1, 1) < 0)
-         return -1;
+      if(rt_inputs[i] == src)
+      {
+         rt_input_count--;
+         mem_move(&rt_inputs[i], &rt_inputs[i + 1], (rt_input_count - i) * sizeof(struct rt_source *));
+         break;
+      }
    }
 
-   if(del_param2 != RT_NONE)
+   if(src->polled)
    {
-      if(del_object_by_id(m->fid, m->id2, 1) < 0)
-         return -1;
+      epoll_ctl(rt_epoll_fd, EPOLL_CTL_DEL, src->fd, NULL);
+      src->polled = 0;
+      rt_epoll_count--;
    }
-   return 0;
 }
 
+/**
+ * wait for data on watched inputs. The wait does not block if a record of an input can already be read.
+ */
+void input_wait()
+{
+   struct epoll_event events[64];
+   int pending = 0;
+   int i, n;
+
+   if(rt_epoll_count == 0)
+      return;
+
+   for(i = 0; (i < rt_input_count) && !pending; i++)
+      pending = source_pending(rt_inputs[i]);
+
+   // outputs may be read while waiting, by a vcd viewer through a fifo for instance
+   if(!pending)
+      sink_flush_all();
+
+   n = epoll_wait(rt_epoll_fd, events, 64, pending ? 0 : -1);
+   for(i = 0; i < n; i++)
+      ((struct rt_source *)events[i].data.ptr)->ready = 1;
+}
 
 /**
- * a new command as been sorted and is ready to be executed
+ * Return the source reading a file descriptor, or NULL
  */
-void exec_cmd(struct rt_msg * m)
+struct rt_source * find_source(int fd)
 {
-   switch(m->cmd)
-   {
-      case RT_DEF_CMD_DECLTASK:
-         exec_decltask(m);
-         break;
-      case RT_DEF_CMD_DECLMUTEX:
-         exec_declmutex(m);
-         break;
-      case RT_DEF_CMD_DECLOBJ:
-         exec_declobj(m);
-         break;
-      case RT_DEF_CMD_SENDMSG:
-         exec_sendmsg(m);
-         break;
-      case RT_DEF_CMD_CALL:
-         exec_call(m);
-         break;
-      case RT_DEF_CMD_RECVMSG:
-         exec_recvmsg(m);
-         break;
-      case RT_DEF_CMD_WAIT:
-         exec_sleep(m);
-         break;
-      case RT_DEF_CMD_SWITCH:
-         exec_switch(m);
-         break;
-      case RT_DEF_CMD_RETURN:
-         exec_return(m);
-         break;
-      case RT_DEF_CMD_COMMENT:
-         exec_comment(m);
-         break;
-      case RT_DEF_CMD_ACTION:
-         exec_action(m);
-         break;
-      case RT_DEF_CMD_SETTIMER:
-         exec_settimer(m);
-         break;
-      case RT_DEF_CMD_TIMEOUT:
-         exec_exptimer(m);
-         break;
-      case RT_DEF_CMD_STOPTIMER:
-         exec_stoptimer(m);
-         break;
-      case RT_DEF_CMD_READY:
-         exec_ready(m);
-         break;
-      case RT_DEF_CMD_PREEMPT:
-         exec_suspend(m);
-         break;
-      case RT_DEF_CMD_CREATTASK:
-         exec_creattask(m);
-         break;
-      case RT_DEF_CMD_CREATMUTEX:
-         exec_creatmutex(m);
-         break;
-      case RT_DEF_CMD_CREATOBJ:
-         exec_creatobj(m);
-         break;
-      case RT_DEF_CMD_TAKE:
-         exec_take(m);
-         break;
-      case RT_DEF_CMD_GIVE:
-         exec_give(m);
-         break;
-      case RT_DEF_CMD_DELMUTEX:
-         exec_delmutex(m);
-         break;
-      case RT_DEF_CMD_DELTASK:
-         exec_deltask(m);
-         break;
-      case RT_DEF_CMD_DELOBJ:
-         exec_delobj(m);
-         break;
-      case RT_DEF_CMD_DECLBOOL:
-         exec_declbool(m);
-         break;
-      case RT_DEF_CMD_DECLWIRE:
-         exec_declwire(m);
-         break;
-      case RT_DEF_CMD_DECLINT:
-         exec_declint(m);
-         break;
-      case RT_DEF_CMD_DECLREAL:
-         exec_declreal(m);
-         break;
-      case RT_DEF_CMD_DECLSTRING:
-         exec_declstring(m);
-         break;
-      case RT_DEF_CMD_SETINT:
-         exec_setint(m);
-         break;
-      case RT_DEF_CMD_SETREAL:
-         exec_setreal(m);
-         break;
-      case RT_DEF_CMD_SETSTRING:
-         exec_setstring(m);
-         break;
-      case RT_DEF_CMD_SETSTATE:
-         exec_setstate(m);
-         break;
-      case RT_DEF_CMD_CREATGRP:
-         exec_creategrp(m);
-         break;
-      case RT_DEF_CMD_DELGRP:
-         exec_delgrp(m);
-         break;
-      case RT_DEF_CMD_RUN:
-         exec_activate(m);
-         break;
-      case RT_DEF_CMD_ACQUIRE:
-         exec_acquire(m);
-         break;
-      case RT_DEF_CMD_DECLEVENT:
-         exec_declevent(m);
-         break;
-      case RT_DEF_CMD_DECLTIME:
-         exec_decltime(m);
-         break;
-      case RT_DEF_CMD_DECLPARAM:
-         exec_declparam(m);
-         break;
-      case RT_DEF_CMD_DECLREG:
-         exec_declreg(m);
-         break;
-      case RT_DEF_CMD_SETEVENT:
-         exec_setevent(m);
-         break;
-      case RT_DEF_CMD_SETPARAM:
-         exec_setparam(m);
-         break;
-      case RT_DEF_CMD_SETREG:
-         exec_setreg(m);
-         break;
-      case RT_DEF_CMD_SETTIME:
-         exec_settime(m);
-         break;
-      case RT_DEF_CMD_SETBOOL:
-         exec_setbool(m);
-         break;
-      case RT_DEF_CMD_SETWIRE:
-         exec_setwire(m);
-         break;
-      case RT_DEF_CMD_STARTDUMP:
-         exec_startdump(m);
-         break;
-      case RT_DEF_CMD_STOPDUMP:
-         exec_stopdump(m);
-         break;
-      case RT_DEF_CMD_DELVAR:
-         exec_delvar(m);
-         break;
-      case RT_DEF_CMD_SETGLOBAL:
-         exec_setglobal(m);
-         break;
+   if((fd < 0) || (fd >= rt_sources_max))
+      return NULL;
+   return rt_sources[fd];
+}
+
+/**
+ * register a new input file, made of text lines or of binary blocks
+ * return NULL if memory is missing
+ */
+struct rt_source * add_source(int fd, int binary)
+{
+   struct rt_source * src;
+
+   if(fd >= rt_sources_max)
+   {
+      int max = 2 * fd + 16;
+      int i;
+      struct rt_source ** sources = (struct rt_source **)heap_realloc(rt_sources, max * sizeof(struct rt_source *));
+      struct rt_source ** heap = (struct rt_source **)heap_realloc(rt_source_heap, max * sizeof(struct rt_source *));
+      if(sources)
+         rt_sources = sources;
+      if(heap)
+         rt_source_heap = heap;
+      if(!sources || !heap)
+         return NULL;
+      for(i = rt_sources_max; i < max; i++)
+         rt_sources[i] = NULL;
+      rt_sources_max = max;
+   }
+
+   src = (struct rt_source *)heap_alloc(sizeof(struct rt_source));
+   if(src == NULL)
+      return NULL;
 
+   src->fd        = fd;
+   src->threaded  = 0;
+   src->worker    = NULL;
+   if((source_open_reader(src, binary) < 0) || (input_add(src) < 0))
+   {
+      source_close_reader(src);
+      heap_free(src);
+      return NULL;
    }
+   src->eof       = 0;
+   src->watermark = 0;
+   src->count     = 0;
+   src->late_max  = 0;
+   src->late_prev = 0;
+   rt_sources[fd] = src;
+
+   rt_source_heap[rt_source_count++] = src;
+   source_sift_up(rt_source_count - 1);
+   return src;
 }
 
 /**
- * some stuf to do before executing any message
- * return 0 is the command can be exectued
- * return -1 else
+ * a new message has been read from a source
  */
-int process_cmd(struct rt_msg * m)
+void source_update(struct rt_source * src, rt_time_t time)
 {
-   int chk_group, chk_param1, chk_param2, new_param1, new_param2, del_param1, del_param2;
-   rt_time_t off;
+   if((src == NULL) || (src->rank < 0) || (time <= src->watermark))
+      return;
 
-#if DEBUG(INFO)
-   INFO_OPT(LOG_HAVE_NEXT                , "exe_cmd %-15s", rt_cmd_name(m->cmd));
-   INFO_OPT(LOG_HAVE_NEXT | LOG_HAVE_PREV, " time %10d", m->time);
-   INFO_OPT(LOG_HAVE_NEXT | LOG_HAVE_PREV, " fid  %8x", m->fid);
-   INFO_OPT(LOG_HAVE_NEXT | LOG_HAVE_PREV, " gid  %8x", m->gid);
-   INFO_OPT(LOG_HAVE_NEXT | LOG_HAVE_PREV, " id1  %8x", m->id1);
-   INFO_OPT(LOG_HAVE_NEXT | LOG_HAVE_PREV, " id2  %8x", m->id2);
-   INFO_OPT(                LOG_HAVE_PREV, " text '%s'\n", m->text);
-#endif
-   // msc check cmd
-   if(m->class & RT_MSC)
-   {
-      // find a correlation for this message
-      if(msc_out)
-         msc_find_corr(m);
+   src->watermark = time;
+   source_sift_down(src->rank);
+}
 
-      /*
-       * VERB("cmd_pre '%s' : time=%d off=%d msc_page=%d msc_page_max_levels=%d msc_level=%d\n",
-       *      rt_cmd_name(m->cmd), msc_get_time(m), m->off, msc_page, msc_page_max_levels, msc_level);
-       */
+/**
+ * the end of a source has been reached: it does not hold back any message anymore
+ */
+void source_end(struct rt_source * src)
+{
+   int i;
 
-      // current level update
-      if (msc_get_time(m) > msc_level)
-      {
-         if(msc_out)
-         {
-            int saved_vcd = vcd_out;
-            int saved_sdl = sdl_out;
+   if((src == NULL) || (src->rank < 0))
+      return;
 
-            // during a page break, disable write accesses to other files
-            vcd_out = 0;
-            sdl_out = 0;
+   src->eof = 1;
+   input_del(src);
+   source_close_reader(src);
+   if(src->threaded)
+      ring_end(&src->ring);
+   i = src->rank;
+   src->rank = -1;
 
-            // break the page each time m->time() - msc_page > msc_page_max_levels
-            while (msc_get_time(m) - msc_page >= msc_page_max_levels)
-            {
-               // compute nextlevel to terminate the page. current msc_level is supposed to be
-               // inside a normal page
-               off = msc_page_max_levels - (msc_level - msc_page);
-               write_line(msc_fd, "\\nextlevel[%d]\n", off);
-               msc_level += off;
-               write_line(msc_fd, "%%level=%d\n", msc_level);
+   rt_source_count--;
+   if(i < rt_source_count)
+   {
+      rt_source_heap[i] = rt_source_heap[rt_source_count];
+      rt_source_heap[i]->rank = i;
+      source_sift_down(i);
+      source_sift_up(rt_source_heap[i]->rank);
+   }
+}
 
-               // start a new page
-               msc_page = msc_level;
+/**
+ * measure how late a message is, before queuing it, and adapt the reorder window to it
+ */
+void queue_adapt(struct rt_event * m)
+{
+   struct rt_source * src = find_source(m->fid);
+   rt_time_t late = 0;
+   rt_time_t window;
+   int i;
 
-               // start a new page
-               msc_dump_stop(msc_fd, m->time);
+   if(!queue_empty() && (m->time < rt_queue_newest))
+      late = rt_queue_newest - m->time;
 
-               write_line(msc_fd, "\\newpage\n");
-               msc_dump_start(msc_fd, "msc", m->time);
-            }
+   if(late > rt_queue_late_max)
+      rt_queue_late_max = late;
 
-            // restore file descriptors
-            vcd_out = saved_vcd;
-            sdl_out = saved_sdl;
+   if(m->time < rt_queue_last)
+      rt_queue_late++;
 
-            // update next level
-            write_line(msc_fd, "\\nextlevel[%d]\n", msc_get_time(m) - msc_level);
+   if(!rt_queue_adapt || (src == NULL))
+      return;
 
-         }
+   if(late > src->late_max)
+      src->late_max = late;
 
-         // set new time
-         msc_level = msc_get_time(m);
+   // at the end of a period, forget the lateness of the previous one, and look for the latest source
+   if(++src->count >= RT_QUEUE_ADAPT_PERIOD)
+   {
+      src->late_prev = src->late_max;
+      src->late_max  = late;
+      src->count     = 0;
 
-         if(msc_out)
+      for(i = 0; i < rt_sources_max; i++)
+      {
+         src = rt_sources[i];
+         if(src && !src->eof)
          {
-            // add a comment
-            write_line(msc_fd, "%%level=%d\n", msc_level);
-            if(msc_mark_grain == MSC_MARK_GRANULARITY_LEVEL) {
-               switch(msc_mark_disp) {
-                  case MSC_MARK_DISPLAY_NONE:
-                     break;
-                  case MSC_MARK_DISPLAY_BOTH:
-                     write_line(msc_fd, "\\mscmark[bl]{%d : %d}{envleft}\n", m->time, msc_level);
-                     break;
-                  case MSC_MARK_DISPLAY_REALTIME:
-                     write_line(msc_fd, "\\mscmark[bl]{%d}{envleft}\n", m->time);
-                     break;
-                  case MSC_MARK_DISPLAY_LEVEL:
-                     write_line(msc_fd, "\\mscmark[bl]{%d}{envleft}\n", msc_level);
-                     break;
-               }
-            }
+            if(src->late_max > late)
+               late = src->late_max;
+            if(src->late_prev > late)
+               late = src->late_prev;
          }
       }
-      else if (msc_get_time(m) < msc_level)
-      {
-         ERROR("old message '%s' at @%d\n", rt_cmd_name(m->cmd), m->time);
-         return -1;
-      }
+   }
+   else if(late + late / 4 + 1 <= rt_queue_flush)
+   {
+      // nothing to widen
+      return;
+   }
 
-      // break correlation if a newpage is between
-      if (msc_out && m->corr && (msc_get_time(m) + m->off - msc_page >= msc_page_max_levels))
-      {
-         m->corr->corr = NULL;
-         m->corr       = NULL;
-         VERB("break correlation\n");
-      }
+   // the window covers the latest source, with a margin of 25%
+   window = late + late / 4 + 1;
+   if(window < rt_queue_min)
+      window = rt_queue_min;
+   if(window > rt_queue_max)
+      window = rt_queue_max;
+
+   if(window > rt_queue_flush)
+   {
+      VERB("widen queue window to %d\n", window);
+      rt_queue_widened++;
    }
+   rt_queue_flush = window;
+}
 
-   // vcd check cmd
-   if(m->class & RT_VCD)
+/**
+ * Return 1 if a queued message can be processed:
+ * - in merge mode, when all live sources have read messages more recent than it, from rt_queue_flush distance.
+ *   This distance leaves time to queue the reception of a sent message.
+ * - otherwise, when it is older than the newest queued message, from rt_queue_flush distance
+ */
+int queue_releasable(struct rt_event * m)
+{
+   if(rt_merge)
+      return (rt_source_count == 0) || (m->time + rt_queue_flush < rt_source_heap[0]->watermark);
+   else
+      return m->time + rt_queue_flush <= rt_queue_newest;
+}
+
+/**
+ * Compute the untimed levels of a message of time t and of class c, following in queue order a message of
+ * time *time and of levels *msc_level and *vcd_level. Levels are incremented when the time increases,
+ * depending on the class of the message.
+ */
+static inline void untimed_step(rt_time_t t, int c, rt_time_t * time, int * msc_level, int * vcd_level)
+{
+   if(t > *time)
    {
-      if (vcd_get_time(m) > vcd_level)
+      *time = t;
+      if(c & RT_MSC)
+         *msc_level += 1;
+      if(c & RT_VCD)
+         *vcd_level += 1;
+   }
+}
+
+/**
+ * assign untimed levels to a message leaving the queue
+ */
+void untimed_release(struct rt_msg * m)
+{
+   if(!untimed_started)
+   {
+      untimed_started = 1;
+      untimed_time    = m->time;
+   }
+   untimed_step(m->time, m->class, &untimed_time, &untimed_msc_level, &untimed_vcd_level);
+   m->msc_level = untimed_msc_level;
+   m->vcd_level = untimed_vcd_level;
+}
+
+/**
+ * Compute the untimed msc level of a queued message, needed when it is correlated before its release.
+ * The level of the last processed message is incremented by the msc slots queued after it, up to the time of k.
+ */
+int untimed_levels(struct rt_event * k)
+{
+   rt_time_t time = untimed_started ? untimed_time : queue_first()->time;
+   int i, j;
+
+   if(k->time <= time)
+      return untimed_msc_level;
+
+   i = slot_bound(time, 1);
+   j = slot_bound(k->time, 0);
+   return untimed_msc_level + untimed_slots[j].rank - (untimed_slots[i].rank - untimed_slots[i].msc);
+}
+
+/**
+ * extract from the queue oldest messages that can be released (see queue_releasable).
+ * Each released message is expanded in a rt_msg, with its untimed levels, then processed.
+ */
+void flush_queue()
+{
+   struct rt_event * e;
+   struct rt_msg m;
+
+   if(queue_empty())
+      return;
+
+   /* execute all messages older than rt_flush_queue */
+   while(!queue_empty())
+   {
+      e = queue_first();
+      if (queue_releasable(e))
       {
-         // set new time
-         vcd_level = vcd_get_time(m);
+         queue_remove_first();
+         rt_queue_last = e->time;
 
-         if ((vcd_level > 0) && vcd_out)
-            write_line(vcd_fd, "#%d\n", vcd_level);
+         event_to_msg(e, &m);
+         untimed_release(&m);
+
+         // process the command (check it, and execute it)
+         process_cmd(&m);
+
+         // free the message
+         text_put(e->text);
+         heap_pool_free(rt_event_pool, e);
       }
-      else if (vcd_get_time(m) < vcd_level)
+      else
       {
-         ERROR("old message '%s' at @%d\n", rt_cmd_name(m->cmd), m->time);
-         return -1;
+         break;
       }
    }
+}
 
-   // see how the command behave with its objects
-   get_cmd_syntax(m, &chk_group, &chk_param1, &chk_param2, &new_param1, &new_param2, &del_param1, &del_param2);
+/**
+ * insert a message in the rt_queue so that the rt_queue is sorted by date, from the oldest one to the newest one.
+ * if added on the top of the queue, all messages m' at head of the queue that verify m'->time < m->time + rt_queue_flush
+ * are removed from the queue and processes.
+ */
+void add_msg(struct rt_event * m)
+{
+   int flush;
 
-   // in vcd fifo mode all symbols must be declared at the beginning of the vcd dump file
-   if((m->class & RT_VCD) && vcd_fifo)
+   m->seq = rt_queue_seq++;
+
+#if DEBUG(INFO)
+   INFO_OPT(LOG_HAVE_NEXT                , "add_cmd %-15s", rt_cmd_name(m->cmd));
+   INFO_OPT(LOG_HAVE_NEXT | LOG_HAVE_PREV, " time %10d", m->time);
+   INFO_OPT(LOG_HAVE_NEXT | LOG_HAVE_PREV, " fid  %8x", m->fid);
+   INFO_OPT(LOG_HAVE_NEXT | LOG_HAVE_PREV, " gid  %8x", m->gid);
+   INFO_OPT(LOG_HAVE_NEXT | LOG_HAVE_PREV, " id1  %8x", m->id1);
+   INFO_OPT(LOG_HAVE_NEXT | LOG_HAVE_PREV, " id2  %8x", m->id2);
+   INFO_OPT(                LOG_HAVE_PREV, " text '%s'\n", text_str(m->text));
+#endif
+
+   queue_adapt(m);
+
+   /* in merge mode, the queue is flushed each time the low watermark may change */
+   if(rt_merge)
    {
-      int sym_def = (new_param1 | new_param2);
+      source_update(find_source(m->fid), m->time);
+      flush = 1;
+   }
+   /* the queue is flushed when the message becomes the newest or the oldest one */
+   else if(queue_empty())
+   {
+      VERB("=> add first\n");
+      flush = 0;
+   }
+   else if (m->time > rt_queue_newest)
+   {
+      VERB("=> add newest + flush queue\n");
+      flush = 1;
+   }
+   else if (m->time < queue_first()->time)
+   {
+      VERB("=> add oldest + flush queue\n");
+      flush = 1;
+   }
+   /* priorize send_msg and timer_msg */
+   else if ((m->time == queue_first()->time) && msg_is_prio(m))
+   {
+      VERB("=> add oldest + flush queue\n");
+      flush = 1;
+   }
+   else
+   {
+      VERB("=> add middle\n");
+      flush = 0;
+   }
 
-      // the value change dump section starts when time is > 0 or when detection something else than a symbol definition
-      if(!vcd_def_end && ((vcd_get_time(m) > 0) || !sym_def))
-      {
-         vcd_write_definitions();
-         vcd_def_end = 1;
-      }
-      else if(vcd_def_end && sym_def)
-      {
-         ERROR("vcd_fifo mode forbid declaration of symbols after definition phasis : cmd '%s' at @%d\n", rt_cmd_name(m->cmd), m->time);
-         return -1;
-      }
+   if(queue_insert(m) < 0)
+   {
+      ERROR("Cannot queue message '%s' at @%d\n", rt_cmd_name(m->cmd), m->time);
+      text_put(m->text);
+      heap_pool_free(rt_event_pool, m);
+      return;
    }
 
-   // check for correct parameter references, and link message to objects
-   if(check_params(m, chk_group, chk_param1, chk_param2))
+   // the message can be correlated as long as it is queued
+   corr_index_add(m);
+
+   if(flush)
+      flush_queue();
+}
+
+/**
+ * allocate a queued message for a parsed command, and add it to the rt_queue
+ * return -1 if memory is missing, 0 otherwise
+ */
+int queue_cmd(int fid, rt_cmd_t cmd, rt_time_t time, object_id_t gid, object_id_t id1, object_id_t id2, char * text)
+{
+   struct rt_event * m = (struct rt_event *) heap_pool_alloc(rt_event_pool);
+
+   if(!m)
+   {
+      ERROR("Cannot allocate one 'rt_event'\n");
       return -1;
+   }
+
+   m->time  = time;
+   m->gid   = gid;
+   m->id1   = id1;
+   m->id2   = id2;
+   m->off   = 0;
+   m->fid   = fid;
+   m->cmd   = cmd;
+   m->flags = 0;
+   m->text  = text_get(text);
+
+   add_msg(m);
+   return 0;
+}
+
+/**
+ * decode a binary record
+ */
+void decode_binary_cmd(char * buffer, int len, struct rt_record * r)
+{
+   if(rt_msg_from_buf(buffer, len, &r->cmd, &r->time, &r->gid, &r->id1, &r->id2, r->text) == 0)
+      r->status = RT_RECORD_CMD;
+   else
+      r->status = RT_RECORD_BAD_BIN;
+}
+
+/**
+ * decode a text line. The line is modified.
+ */
+void decode_text_cmd(char * buffer, struct rt_record * r)
+{
+   if(rt_msg_from_string(buffer, &r->cmd, &r->time, &r->gid, &r->id1, &r->id2, r->text) == 0)
+   {
+      r->status = RT_RECORD_CMD;
+   }
+   else if(buffer[0] == '#' || buffer[0] == '%' || buffer[0] == '\0')
+   {
+      // this is interpreted as a comment in the source file
+      r->status = RT_RECORD_SKIP;
+   }
+   else
+   {
+      // keep what the parser left of the line, for the error message
+      r->status = RT_RECORD_BAD;
+      string_ncpy(r->text, buffer, sizeof(r->text) - 1);
+      r->text[sizeof(r->text) - 1] = '\0';
+   }
+}
+
+/**
+ * add a decoded record to the rt_queue
+ * return -1 if the record is invalid or if memory is missing, 0 otherwise
+ */
+int queue_record(int fid, struct rt_record * r)
+{
+   switch(r->status)
+   {
+      case RT_RECORD_CMD:
+         return queue_cmd(fid, r->cmd, r->time, r->gid, r->id1, r->id2, r->text);
+      case RT_RECORD_BAD_BIN:
+         ERROR("Invalid binary cmd\n");
+         return -1;
+      case RT_RECORD_BAD:
+         ERROR("Invalid cmd : %s\n", r->text);
+         return -1;
+      default:
+         return 0;
+   }
+}
+
+/**
+ * given a binary command, parse it and at it to the rt_queue.
+ * Then process the new rt_queue
+ */
+int read_binary_cmd(int fid, char * buffer, int len)
+{
+   struct rt_record r;
+#if DEBUG(VERB)
+   int i;
+
+   VERB_OPT(LOG_HAVE_NEXT, "read_bin %d bytes\n", len);
+   for(i = 0; i < len; i++)
+      VERB_OPT(LOG_HAVE_NEXT | LOG_HAVE_PREV, ":%02x", buffer[i]);
+   VERB_OPT(LOG_HAVE_PREV, "\n");
+#endif
+
+   decode_binary_cmd(buffer, len, &r);
+   return queue_record(fid, &r);
+}
+
+
+/**
+ * given a text command, parse it and at it to the rt_queue.
+ * Then process the new rt_queue
+ */
+int read_text_cmd(int fid, char * buffer, int len)
+{
+   struct rt_record r;
 
-   // allocate new objects and link them to obj1 or obj2
-   if(alloc_params(m, new_param1, new_param2))
-      return -1;
+   VERB("read_text : %s\n", buffer);
 
-   // execute the command
-   exec_cmd(m);
+   decode_text_cmd(buffer, &r);
+   return queue_record(fid, &r);
+}
 
-   // free the objects that are no more necessary
-   if(free_params(m, del_param1, del_param2))
-      return -1;
+/**
+ * wake up the main thread or a decode worker waiting on cond, if waiting is set.
+ * The fence orders the commits made before with the read of waiting, see sink_push_block.
+ */
+static void worker_wake(struct rt_worker * w, int * waiting, pthread_cond_t * cond)
+{
+   __atomic_thread_fence(__ATOMIC_SEQ_CST);
+   if(__atomic_load_n(waiting, __ATOMIC_SEQ_CST))
+   {
+      pthread_mutex_lock(&w->lock);
+      pthread_cond_signal(cond);
+      pthread_mutex_unlock(&w->lock);
+   }
+}
+
+/**
+ * return 1 if a ring of a decode worker has room for a record
+ */
+static int worker_room(struct rt_worker * w)
+{
+   int i;
 
+   for(i = 0; i < w->count; i++)
+   {
+      if(ring_push_slot(&w->sources[i]->ring))
+         return 1;
+   }
    return 0;
 }
 
-
 /**
- * extract from the queue oldest messages, that are older than the newest ones, from rt_queue_flush distance.
- * In untimed mode, this function will first recompute all untimed levels for the whole queue
+ * Decode worker: decode records of its inputs in their rings, until the end of all of them.
+ * Only regular files are decoded by workers: reading them never blocks.
  */
-void flush_queue()
+void * decode_worker(void * arg)
 {
-   list_node_t * node, * tmp;
-   struct rt_msg * m;
-
-   rt_time_t end_time = list_entry(rt_queue.pprev, struct rt_msg, node)->time;
-   rt_time_t start_time = list_entry(rt_queue.pnext, struct rt_msg, node)->time;
+   struct rt_worker * w = (struct rt_worker *)arg;
+   struct rt_record * r;
+   struct rt_source * src;
+   char * record;
+   int i, n, len, busy;
 
-   if(start_time + rt_queue_flush <= end_time)
+   while((w->count > 0) && !__atomic_load_n(&w->stop, __ATOMIC_ACQUIRE))
    {
-      if (msc_untimed || vcd_untimed)
+      busy = 0;
+      for(i = 0; i < w->count; i++)
       {
-         /* initialize previous parameters */
-         rt_time_t msc_level = list_entry(rt_queue.pnext, struct rt_msg, node)->msc_level;
-         rt_time_t vcd_level = list_entry(rt_queue.pnext, struct rt_msg, node)->vcd_level;
-         rt_time_t rt_level = start_time;
-
-         /* compute all untimed levels in untimed mode */
-         list_for_each(node, &rt_queue)
+         src = w->sources[i];
+         for(n = 0; n < RT_RING_SIZE / 4; n++)
          {
-            m = list_entry(node, struct rt_msg, node);
-            if(m->time > rt_level)
+            r = (struct rt_record *)ring_push_slot(&src->ring);
+            if(r == NULL)
+               break;
+
+            len = source_next(src, 1, &record);
+            if(len == 0)
+               r->status = RT_RECORD_END;
+            else if(src->binary)
+               decode_binary_cmd(record, len, r);
+            else
+               decode_text_cmd(record, r);
+
+            busy = 1;
+            if(len == 0)
             {
-               rt_level = m->time;
-               if(m->class & RT_MSC)
-                  msc_level += 1;
-               if(m->class & RT_VCD)
-                  vcd_level += 1;
+               // the source is not accessed anymore once its end is committed
+               w->sources[i--] = w->sources[--w->count];
+               ring_push_commit(&src->ring);
+               break;
             }
-            m->msc_level = msc_level;
-            m->vcd_level = vcd_level;
+            ring_push_commit(&src->ring);
          }
       }
 
-      /* execute all messages older than rt_flush_queue */
-      list_for_each_safe(node, tmp, &rt_queue)
+      if(busy)
       {
-         m = list_entry(node, struct rt_msg, node);
-         if (m->time + rt_queue_flush <= end_time)
-         {
-            list_delete(&m->node);
-
-            // process the command (check it, and execute it)
-            process_cmd(m);
-
-            // free the message
-            heap_free(m);
-         }
-         else
-         {
-            break;
-         }
+         worker_wake(w, &w->waited, &w->records);
+      }
+      else
+      {
+         // all rings are full: sleep until the merger consumes them
+         pthread_mutex_lock(&w->lock);
+         __atomic_store_n(&w->sleeping, 1, __ATOMIC_SEQ_CST);
+         while(!w->stop && !worker_room(w))
+            pthread_cond_wait(&w->room, &w->lock);
+         __atomic_store_n(&w->sleeping, 0, __ATOMIC_SEQ_CST);
+         pthread_mutex_unlock(&w->lock);
       }
    }
+   return NULL;
 }
 
 /**
- * insert a message in the rt_queue so that the rt_queue is sorted by date, from the oldest one to the newest one.
- * if added on the top of the queue, all messages m' at head of the queue that verify m'->time < m->time + rt_queue_flush
- * are removed from the queue and processes.
+ * return the next record decoded by the worker of a source, waiting for it if the ring is empty
  */
-void add_msg(struct rt_msg * m)
+struct rt_record * worker_pop(struct rt_source * src)
 {
-   list_node_t * node;
-   struct rt_msg * mbis;
-
-   // find to which classes the message belong
-   m->class = classify_cmd(m->cmd);
-
-#if DEBUG(INFO)
-   INFO_OPT(LOG_HAVE_NEXT                , "add_cmd %-15s", rt_cmd_name(m->cmd));
-   INFO_OPT(LOG_HAVE_NEXT | LOG_HAVE_PREV, " time %10d", m->time);
-   INFO_OPT(LOG_HAVE_NEXT | LOG_HAVE_PREV, " fid  %8x", m->fid);
-   INFO_OPT(LOG_HAVE_NEXT | LOG_HAVE_PREV, " gid  %8x", m->gid);
-   INFO_OPT(LOG_HAVE_NEXT | LOG_HAVE_PREV, " id1  %8x", m->id1);
-   INFO_OPT(LOG_HAVE_NEXT | LOG_HAVE_PREV, " id2  %8x", m->id2);
-   INFO_OPT(                LOG_HAVE_PREV, " text '%s'\n", m->text);
-#endif
-
-   if(list_empty(&rt_queue))
-   {
-      VERB("=> add_tail\n");
-      list_add_tail(&m->node, &rt_queue);
-   }
-   /* retrive the top of the queue */
-   else if (m->time > list_entry(rt_queue.pprev, struct rt_msg, node)->time)
-   {
-      VERB("=> add_tail + flush queue\n");
-      list_add_tail(&m->node, &rt_queue);
-
-      flush_queue();
-   }
-   else if (m->time < list_entry(rt_queue.pnext, struct rt_msg, node)->time)
-   {
-      VERB("=> add_head + flush queue\n");
-      list_add_head(&m->node, &rt_queue);
+   struct rt_worker * w = src->worker;
+   struct rt_record * r = (struct rt_record *)ring_pop_slot(&src->ring);
 
-      flush_queue();
-   }
-	 /* priorize send_msg and timer_msg */
-   else if ((m->time == list_entry(rt_queue.pnext, struct rt_msg, node)->time)
-		  	 && ((m->cmd == RT_DEF_CMD_SENDMSG) || (m->cmd == RT_DEF_CMD_TIMEOUT)))
+   if(r == NULL)
    {
-      VERB("=> add_head + flush queue\n");
-      list_add_head(&m->node, &rt_queue);
-
-      flush_queue();
+      pthread_mutex_lock(&w->lock);
+      __atomic_store_n(&w->waited, 1, __ATOMIC_SEQ_CST);
+      while((r = (struct rt_record *)ring_pop_slot(&src->ring)) == NULL)
+         pthread_cond_wait(&w->records, &w->lock);
+      __atomic_store_n(&w->waited, 0, __ATOMIC_SEQ_CST);
+      pthread_mutex_unlock(&w->lock);
    }
-   else
-   {
-		  /* for most messages >= is the best choice. For send msg and timeout we need a > to prioritize */
-			int strict = ((m->cmd == RT_DEF_CMD_SENDMSG) || (m->cmd == RT_DEF_CMD_TIMEOUT)) ? 1 : 0;
+   return r;
+}
 
-      /* msg will be inserted in ascending order, starting from the newest ones (most probable) */
-      list_for_each_rev(node, &rt_queue)
-      {
-         mbis = list_entry(node, struct rt_msg, node);
-				 /* si m est un  */
-         if (m->time >= mbis->time + strict)
-			   {
-						VERB("=> add_middle strict=%d\n", strict);
-						list_insert_after(&m->node, &mbis->node);
-						break;
-         }
-      }
-   }
+/**
+ * release the record returned by worker_pop. A worker only sleeps when all its rings are full, so it is woken up
+ * once, when the ring is half consumed.
+ */
+void worker_pop_commit(struct rt_source * src)
+{
+   ring_pop_commit(&src->ring);
+   if(ring_count(&src->ring) == RT_RING_SIZE / 2)
+      worker_wake(src->worker, &src->worker->sleeping, &src->worker->room);
 }
 
 /**
- * given a text command, parse it and at it to the rt_queue.
- * Then process the new rt_queue
+ * stop and wait for the first started decode workers, then release the first count ones.
+ * Workers that have decoded all their inputs already ended by themselves.
  */
-int read_binary_cmd(int fid, char * buffer, int len)
+static void end_workers(int started, int count)
 {
-   struct rt_msg * m = (struct rt_msg *) heap_alloc(sizeof(struct rt_msg));
-   int rc;
+   int i;
 
-   if(!m)
+   for(i = 0; i < started; i++)
    {
-      ERROR("Cannot allocate one 'rt_msg'\n");
-      return -1;
+      pthread_mutex_lock(&rt_workers[i].lock);
+      __atomic_store_n(&rt_workers[i].stop, 1, __ATOMIC_RELEASE);
+      pthread_cond_signal(&rt_workers[i].room);
+      pthread_mutex_unlock(&rt_workers[i].lock);
    }
+   for(i = 0; i < started; i++)
+      pthread_join(rt_workers[i].thread, NULL);
 
-#if DEBUG(VERB)
-   VERB_OPT(LOG_HAVE_NEXT, "read_bin %d bytes\n", len);
-   for(rc = 0; rc < len; rc++)
-      VERB_OPT(LOG_HAVE_NEXT | LOG_HAVE_PREV, ":%02x", buffer[rc]);
-   VERB_OPT(LOG_HAVE_PREV, "\n");
-#endif
-
-   m->off = 0;
-   m->corr = NULL;
-   m->msc_level = 0;
-   m->vcd_level = 0;
-   m->fid = fid;
-
-   // the way we extract a command depends on the encoding (text or binary)
-   rc = rt_msg_from_buf(buffer, len, &m->cmd, &m->time, &m->gid, &m->id1, &m->id2, m->text);
-
-   if (rc == 0)
-   {
-      add_msg(m);
-   }
-   else
+   for(i = 0; i < count; i++)
    {
-      ERROR("Invalid binary cmd\n");
-      return -1;
+      heap_free(rt_workers[i].sources);
+      pthread_mutex_destroy(&rt_workers[i].lock);
+      pthread_cond_destroy(&rt_workers[i].room);
+      pthread_cond_destroy(&rt_workers[i].records);
    }
-   return 0;
+   heap_free(rt_workers);
+   rt_workers = NULL;
 }
 
-
 /**
- * given a text command, parse it and at it to the rt_queue.
- * Then process the new rt_queue
+ * start decode workers. Regular files are shared between them, other inputs are still decoded by the main thread.
+ * return -1 if a worker cannot be started, 0 otherwise
  */
-int read_text_cmd(int fid, char * buffer, int len)
+int start_workers()
 {
-   struct rt_msg * m = (struct rt_msg *) heap_alloc(sizeof(struct rt_msg));
-   int rc;
+   int i, j;
 
-   VERB("read_text : %s\n", buffer);
-   if(!m)
-   {
-      ERROR("Cannot allocate one 'rt_msg'\n");
+   rt_workers = (struct rt_worker *)heap_alloc(rt_threads * sizeof(struct rt_worker));
+   if(rt_workers == NULL)
       return -1;
-   }
-
-   m->off = 0;
-   m->corr = NULL;
-   m->msc_level = 0;
-   m->vcd_level = 0;
-   m->fid = fid;
 
-   // the way we extract a command depends on the encoding (text or binary)
-   rc = rt_msg_from_string(buffer, &m->cmd, &m->time, &m->gid, &m->id1, &m->id2, m->text);
-      
-   if (rc == 0)
+   for(i = 0; i < rt_threads; i++)
    {
-      add_msg(m);
+      struct rt_worker * w = &rt_workers[i];
+
+      w->count    = 0;
+      w->stop     = 0;
+      w->sleeping = 0;
+      w->waited   = 0;
+      pthread_mutex_init(&w->lock, NULL);
+      pthread_cond_init(&w->room, NULL);
+      pthread_cond_init(&w->records, NULL);
+      w->sources  = (struct rt_source **)heap_alloc(rt_input_count * sizeof(struct rt_source *));
+      if(w->sources == NULL)
+      {
+         end_workers(0, i + 1);
+         return -1;
+      }
    }
-   else if(buffer[0] == '#' || buffer[0] == '%' || buffer[0] == '\0')
+
+   for(i = 0, j = 0; i < rt_input_count; i++)
    {
-      // this is interpreted as a comment in the source file
+      struct rt_source * src = rt_inputs[i];
+      if(src->polled || (ring_init(&src->ring, RT_RING_SIZE, sizeof(struct rt_record)) < 0))
+         continue;
+
+      src->threaded = 1;
+      src->worker   = &rt_workers[j];
+      rt_workers[j].sources[rt_workers[j].count++] = src;
+      j = (j + 1) % rt_threads;
    }
-   else
+
+   for(i = 0; i < rt_threads; i++)
    {
-      ERROR("Invalid cmd : %s\n", buffer);
-      return -1;
+      if(pthread_create(&rt_workers[i].thread, NULL, decode_worker, &rt_workers[i]) != 0)
+      {
+         ERROR("Cannot start decode worker %d\n", i);
+         end_workers(i, rt_threads);
+         for(j = 0; j < rt_input_count; j++)
+         {
+            if(rt_inputs[j]->threaded)
+            {
+               ring_end(&rt_inputs[j]->ring);
+               rt_inputs[j]->threaded = 0;
+               rt_inputs[j]->worker   = NULL;
+            }
+         }
+         return -1;
+      }
    }
    return 0;
 }
 
+/**
+ * wait for the end of decode workers
+ */
+void stop_workers()
+{
+   end_workers(rt_threads, rt_threads);
+}
+
 void display_help()
 {
    fprintf(stdout, "Syntax:\n");
@@ -3231,8 +7240,26 @@ void display_help()
    fprintf(stdout, "Options:\n");
    fprintf(stdout, "\t-freq <hz>             : (100000) frequency at which the rt_time clock is working\n");
    fprintf(stdout, "\t-queue <ticks>         : (1000) maximum rt_time_t between the oldest and newest msg in the queue\n");
+   fprintf(stdout, "\t-queue_algo <n>        : reorder algorithm 0=sorted list, 1=binary heap(def)\n");
+   fprintf(stdout, "\t-merge                 : process a message once all sources have read messages newer by -queue ticks\n");
+   fprintf(stdout, "\t-batch <n>             : (1) number of records read from an input before reading the next one\n");
+   fprintf(stdout, "\t-threads <n>           : (0) number of threads decoding input files\n");
+   fprintf(stdout, "\t-writers               : write each output file from its own thread\n");
+   fprintf(stdout, "\t-out_buffer <n>        : (65536) size of output buffers, in bytes\n");
+   fprintf(stdout, "\t-queue_adapt           : adapt the -queue window to the observed lateness of messages\n");
+   fprintf(stdout, "\t-queue_min <ticks>     : (1) minimum adaptive window\n");
+   fprintf(stdout, "\t-queue_max <ticks>     : (1000000) maximum adaptive window\n");
+   fprintf(stdout, "\t-stats                 : print memory pool statistics at exit\n");
    fprintf(stdout, "\t-vcd <file>            : output a vcd file\n");
    fprintf(stdout, "\t-msc <file>            : output a msc-latex file\n");
+   fprintf(stdout, "\t-msc_svg <dir>         : output msc pages as svg files in a directory\n");
+   fprintf(stdout, "\t-msc_gap <ticks>       : (0) collapse idle spans longer than ticks into one level, in timed mode\n");
+   fprintf(stdout, "\t-msc_aggregate <ticks> : (0) draw once identical messages, actions and states repeated within ticks\n");
+   fprintf(stdout, "\t-msc_cull              : only show on each msc page the instances it uses\n");
+   fprintf(stdout, "\t-msc_page_max_instances <n> : (0) split msc pages showing more than n instances in several sheets\n");
+   fprintf(stdout, "\t-msc_jobs <n>          : (0) compile msc pages to pdf in n worker processes during the simulation\n");
+   fprintf(stdout, "\t-msc_batch <n>         : (1) msc pages per latex unit compiled by a worker, with -msc_jobs\n");
+   fprintf(stdout, "\t-msc_cache <dir>       : reuse the msc units compiled by previous runs in a directory\n");
    fprintf(stdout, "\t-sdl <file>            : output a sdl dot file\n");
    fprintf(stdout, "\t-log <level>           : 0=NONE, 1=ASSERT, 2=ERROR, 3=INFO, 4=VERB\n");
    fprintf(stdout, "\t-msc_untimed           : increase time one by one for msc\n");
@@ -3244,45 +7271,63 @@ void display_help()
    fprintf(stdout, "\t-msc_mark_grain   <m>  : mark granularity 0:none, 1:page, 2:level\n");
    fprintf(stdout, "\t-msc_mark_disp    <m>  : mark display 0:none, 1:real, 2:level, 3=both\n");
    fprintf(stdout, "\t-vcd_untimed           : increase time one by one for vcd\n");
+   fprintf(stdout, "\t-vcd_header <n>        : (65536) bytes reserved for vcd definitions before value changes\n");
 }
 
 int main(int argc, char ** argv)
 {
-   int nfds = 0;
-   fd_set fds, rfds, bfds;
+   struct rt_source * src;
    int fd;
-   int fdmax=0;
-   char buffer[RT_CFG_MAX_COMMAND_LEN];
+   char * record;
    int len;
    int i;
 
-   char args[512];
+   char * args;
+   int args_len = 1;
    char * p;
    char * f;
 
    char msc_doc[RT_CFG_MAX_TEXT_LEN] = "";
    char sdl_doc[RT_CFG_MAX_TEXT_LEN] = "";
    char vcd_doc[RT_CFG_MAX_TEXT_LEN] = "";
+   char msc_svg[RT_CFG_MAX_TEXT_LEN] = "";
    char title[RT_CFG_MAX_TEXT_LEN] = "";
 
-   // clear descriptors
-   FD_ZERO(&fds);
-   FD_ZERO(&rfds);
-   FD_ZERO(&bfds);
-
    // register a new log handler
    lib_set_log_handler(rtsv_log_handler, NULL);
 
-   // init the queue of messages
-   list_init(&rt_queue);
+   // init memory pools
+   rt_event_pool  = heap_pool_create("rt_event",  sizeof(struct rt_event),  1024);
+   rt_object_pool = heap_pool_create("rt_object", sizeof(struct rt_object), 256);
+   if(!rt_event_pool || !rt_object_pool)
+   {
+      ERROR("Cannot allocate memory pools\n");
+      return -1;
+   }
+
+   // init object indexes
+   hash_init(&rt_local_index, 256);
+   hash_init(&rt_global_index, 64);
+   hash_init(&rt_zombie_index, 64);
+   hash_init(&rt_corr_index, 256);
+   list_init(&rt_graveyard);
+   hash_init(&rt_text_index, 256);
 
    // init top
    init_object(&top, "top", 0, 0, RT_GROUP, NULL, 0);
-   top.global = 1;
-   top.global_id = 0;
+   set_object_global(&top, 0);
 
-   // options
-   gopt_format(argc, argv, args, sizeof(args));
+   // options. Inputs are given on the command line: the options string is sized from it, as each character may be
+   // escaped, and each option separated.
+   for(i = 0; i < argc; i++)
+      args_len += 2 * string_len(argv[i]) + 1;
+   args = (char *)heap_alloc(args_len);
+   if(args == NULL)
+   {
+      ERROR("Cannot allocate options\n");
+      return -1;
+   }
+   gopt_format(argc, argv, args, args_len - 1);
 
    if(gopt_find("-h", args, 512) || gopt_find("--help", args, 512))
    {
@@ -3294,12 +7339,31 @@ int main(int argc, char ** argv)
    gopt_string  (vcd_doc,             "-vcd", args, RT_CFG_MAX_TEXT_LEN);
    gopt_string  (sdl_doc,             "-sdl", args, RT_CFG_MAX_TEXT_LEN);
    gopt_string  (msc_doc,             "-msc", args, RT_CFG_MAX_TEXT_LEN);
+   gopt_string  (msc_svg,             "-msc_svg", args, RT_CFG_MAX_TEXT_LEN);
+   gopt_integer(&msc_gap,             "-msc_gap", args);
+   gopt_integer(&msc_aggregate,       "-msc_aggregate", args);
+   gopt_bool   (&msc_cull,            "-msc_cull", args);
+   gopt_integer(&msc_page_max_instances, "-msc_page_max_instances", args);
+   gopt_integer(&msc_jobs,            "-msc_jobs", args);
+   gopt_integer(&msc_batch,           "-msc_batch", args);
+   gopt_string  (msc_cache,           "-msc_cache", args, RT_CFG_MAX_TEXT_LEN);
    gopt_integer(&rt_log_level,        "-log", args);
    gopt_bool   (&vcd_fifo,            "-vcd_fifo", args);
+   gopt_integer(&vcd_header,          "-vcd_header", args);
    gopt_bool   (&msc_untimed,         "-msc_untimed", args);
    gopt_bool   (&vcd_untimed,         "-vcd_untimed", args);
    gopt_long   (&rt_freq,             "-freq", args);
    gopt_integer(&rt_queue_flush,      "-queue", args);
+   gopt_integer((int*)&rt_queue_algo, "-queue_algo", args);
+   gopt_bool   (&rt_merge,            "-merge", args);
+   gopt_integer(&rt_input_batch,      "-batch", args);
+   gopt_integer(&rt_threads,          "-threads", args);
+   gopt_bool   (&rt_writers,          "-writers", args);
+   gopt_integer(&rt_out_buffer,       "-out_buffer", args);
+   gopt_bool   (&rt_queue_adapt,      "-queue_adapt", args);
+   gopt_bool   (&rt_stats,            "-stats", args);
+   gopt_integer((int*)&rt_queue_min,  "-queue_min", args);
+   gopt_integer((int*)&rt_queue_max,  "-queue_max", args);
    gopt_integer(&msc_inst_dist,       "-msc_inst_dist", args);
    gopt_integer(&msc_level_height,    "-msc_level_height", args);
    gopt_integer(&msc_box_height,      "-msc_box_height", args);
@@ -3316,22 +7380,110 @@ int main(int argc, char ** argv)
    printf("msc_inst_dist        = %d\n", msc_inst_dist);
    printf("msc_out              = %d\n", msc_out);
 
+   if(rt_queue_adapt)
+   {
+      if(rt_queue_flush < rt_queue_min)
+         rt_queue_flush = rt_queue_min;
+      if(rt_queue_flush > rt_queue_max)
+         rt_queue_flush = rt_queue_max;
+   }
+
+   if((rt_queue_algo != RT_QUEUE_LIST) && (rt_queue_algo != RT_QUEUE_HEAP))
+   {
+      ERROR("Unknown queue algorithm %d\n", rt_queue_algo);
+      return -1;
+   }
+
+   if(rt_input_batch < 1)
+      rt_input_batch = 1;
+
+   if(rt_out_buffer < RT_CFG_MAX_COMMAND_LEN)
+      rt_out_buffer = RT_CFG_MAX_COMMAND_LEN;
+
+   if(msc_batch < 1)
+      msc_batch = 1;
+
    // msc file
    if (string_len(msc_doc) > 0)
    {
-      msc_fd = open("/tmp/msc_doc", O_CREAT|O_WRONLY|O_TRUNC, 0666);
-      if(msc_fd < 0)
+      int slen = string_len(msc_doc) - 1;
+      while(slen > 0)
+      {
+         if (msc_doc[slen] == '.')
+            break;
+         slen--;
+      }
+      if(slen > 0)
+      {
+         string_ncpy(msc_base, msc_doc, slen);
+         msc_base[slen] = 0;
+      }
+      else
+      {
+         string_cpy(msc_base, msc_doc);
+      }
+
+      // units are cached, so they must be compiled separately
+      if((string_len(msc_cache) > 0) && (msc_jobs == 0))
+         msc_jobs = 1;
+
+      if((string_len(msc_cache) > 0) && (mkdir(msc_cache, 0777) < 0) && (access(msc_cache, W_OK) < 0))
       {
-         ERROR("Cannot open '/tmp/msc_doc' for write\n");
+         ERROR("Cannot write the msc cache in %s\n", msc_cache);
          return -1;
       }
 
-      msc_new_doc(msc_fd);
+      if(msc_jobs > 0)
+      {
+         // one unit per batch of pages, instead of the whole document
+         msc_job_list = (struct msc_job *)heap_alloc(msc_jobs * sizeof(struct msc_job));
+         if(msc_job_list == NULL)
+            return -1;
+         mem_set(msc_job_list, 0, msc_jobs * sizeof(struct msc_job));
 
-      if(msc_out)
-         msc_dump_start(msc_fd, "msc", 0);
+         if(msc_unit_open() < 0)
+            return -1;
+      }
+      else
+      {
+         msc_fd = open(msc_doc, O_CREAT|O_WRONLY|O_TRUNC, 0666);
+         if(msc_fd < 0)
+         {
+            ERROR("Cannot open %s for write\n", msc_doc);
+            return -1;
+         }
+
+         sink_open(msc_fd);
+         msc_new_doc(msc_fd);
+      }
+   }
+   else
+   {
+      msc_jobs = 0;
+      msc_cull = 0;
+      msc_page_max_instances = 0;
+   }
+
+   msc_buffered = msc_cull || (msc_page_max_instances > 0);
+   if(msc_buffered && (msc_page_open() < 0))
+   {
+      ERROR("Cannot buffer msc pages\n");
+      return -1;
    }
 
+   // msc svg pages
+   if (string_len(msc_svg) > 0)
+   {
+      if(svg_open(msc_svg, msc_level_height, msc_box_height, msc_inst_dist) < 0)
+      {
+         ERROR("Cannot write svg pages in %s\n", msc_svg);
+         return -1;
+      }
+   }
+
+   if(msc_out && msc_output())
+      msc_dump_start(msc_fd, "msc", 0);
+
    // sdl file
    if (string_len(sdl_doc) > 0)
    {
@@ -3341,6 +7493,7 @@ int main(int argc, char ** argv)
          ERROR("Cannot open %s for write\n", sdl_doc);
          return -1;
       }
+      sink_open(sdl_fd);
       sdl_out = 1;
    }
 
@@ -3360,33 +7513,50 @@ int main(int argc, char ** argv)
       }
       else
       {
-         // two temporar files will be created for definitions and value changes. At the end of the simulation, the two files are 'cat' to vcd_doc
-         vcd_def_fd = open("/tmp/def.vcd", O_CREAT | O_WRONLY|O_TRUNC, 0666);
-         if (vcd_def_fd < 0)
+         char path[RT_CFG_MAX_TEXT_LEN + 8];
+
+         // value changes are written in vcd_doc after vcd_header bytes. Definitions are written in an unnamed temporary
+         // file next to it, and copied at the beginning of vcd_doc at the end of the simulation
+         vcd_fd = open(vcd_doc, O_CREAT|O_RDWR|O_TRUNC, 0666);
+         if ((vcd_fd < 0) || (lseek(vcd_fd, vcd_header, SEEK_SET) < 0))
          {
-            ERROR("Cannot open '/tmp/def.vcd' for write\n");
+            ERROR("Cannot open %s for write\n", vcd_doc);
             return -1;
          }
-         vcd_fd = open("/tmp/sim.vcd", O_CREAT|O_WRONLY|O_TRUNC, 0666);
-         if (vcd_fd < 0)
+         vcd_def_fd = temp_file(vcd_doc, path);
+         if (vcd_def_fd < 0)
          {
-            ERROR("Cannot open '/tmp/sim.vcd' for write\n");
+            ERROR("Cannot create a temporary file next to %s\n", vcd_doc);
             return -1;
          }
+         unlink(path);
       }
 
+      sink_open(vcd_fd);
+      sink_open(vcd_def_fd);
       vcd_new_doc(vcd_def_fd, title);
    }
 
+   // inputs that may block are watched by epoll
+   rt_epoll_fd = epoll_create1(0);
+   if (rt_epoll_fd < 0)
+   {
+      ERROR("Cannot create epoll instance\n");
+      return -1;
+   }
+
    // open input files for reading
    p = gopt_find("--", args, 512);
  
    if (p == NULL)
    {
       INFO("read from 'stdin'\n");
-      fdmax = open("/dev/stdin", O_RDONLY, 0666);
-      FD_SET(fdmax, &rfds);
-      nfds = 1;
+      fd = open("/dev/stdin", O_RDONLY, 0666);
+      if(add_source(fd, 0) == NULL)
+      {
+         ERROR("Cannot read 'stdin'\n");
+         return -1;
+      }
    }
    else
    {
@@ -3417,17 +7587,14 @@ int main(int argc, char ** argv)
                ext = "";
 
             fd = open(f, O_RDWR);
-            if (fd > 0)
+            if ((fd > 0) && (add_source(fd, string_cmp(ext, "bin") == 0) == NULL))
+            {
+               ERROR("-E cannot read '%s'\n", f);
+               close(fd);
+            }
+            else if (fd > 0)
             {
                INFO("'%s' opened, fd=%d ext='%s'\n", f, fd, ext);
-               FD_SET(fd, &rfds);
-               if (fd > fdmax)
-                  fdmax = fd;
-
-               if(string_cmp(ext, "bin") == 0)
-                  FD_SET(fd, &bfds);
-
-               nfds++;
             }
             else
             {
@@ -3437,120 +7604,175 @@ int main(int argc, char ** argv)
       }
    }
 
-   // process all input files at the same time open input files for reading
-   while (nfds > 0)
+   if((rt_threads > 0) && (start_workers() < 0))
+      return -1;
+
+   // process all input files at the same time: each input in turn gives up to rt_input_batch records
+   while (rt_input_count > 0)
    {
-      // reload file descriptors to read
-      mem_cpy(&fds, &rfds, sizeof(fds));
+      int n;
+
+      input_wait();
 
-      int nfdsr = select(fdmax + 1, &fds, NULL, NULL, NULL);
-      for (fd = 0; fd <= fdmax; fd++)
+      for (i = 0; i < rt_input_count; i++)
       {
-         if (FD_ISSET(fd, &fds))
-         {
-            int binary = FD_ISSET(fd, &bfds);
+         src = rt_inputs[i];
+         fd  = src->fd;
 
-            // read a line in text mode or a block of data in binary mode
-            if(binary)
-               len = read_data(fd, buffer, RT_CFG_MAX_COMMAND_LEN);
+         for (n = 0; n < rt_input_batch; n++)
+         {
+            if(src->threaded)
+            {
+               // wait for the worker, so that records are merged in the same order as without workers
+               struct rt_record * r = worker_pop(src);
+
+               len = (r->status == RT_RECORD_END) ? 0 : 1;
+               if(len)
+                  queue_record(fd, r);
+               worker_pop_commit(src);
+               if(len)
+                  continue;
+            }
             else
-               len = read_line(fd, buffer, RT_CFG_MAX_COMMAND_LEN);
+            {
+               // read a line in text mode or a block of data in binary mode
+               len = source_next(src, src->ready || !src->polled, &record);
+               src->ready = 0;
+            }
 
-            if(len <= 0)
+            if(len < 0)
+            {
+               // record not completely received yet
+               break;
+            }
+            else if(len == 0)
             {
-               // remove descriptor from the list
-               FD_CLR(fd, &rfds);
                INFO("fd %d end of file\n", fd);
-               nfds--;
+
+               // this source does not hold back queued messages anymore, and leaves rt_inputs
+               source_end(src);
+               i--;
+               if(rt_merge)
+                  flush_queue();
+               break;
             }
-            else if(binary)
+            else if(src->binary)
             {
-               read_binary_cmd(fd, buffer, len);
+               read_binary_cmd(fd, record, len);
             }
             else
             {
-               read_text_cmd(fd, buffer, len);
+               read_text_cmd(fd, record, len);
             }
          }
       }
    }
+   if(rt_threads > 0)
+      stop_workers();
+
+   if(rt_queue_adapt)
+   {
+      printf("queue window         = %d (widened %d times)\n", rt_queue_flush, rt_queue_widened);
+      printf("queue max lateness   = %d\n", rt_queue_late_max);
+      printf("queue late messages  = %d\n", rt_queue_late);
+   }
+
    // flush last queued messages
    rt_queue_flush = 0;
    flush_queue();
 
+   if(msc_gap_count)
+      printf("msc gaps             = %d (%d ticks)\n", msc_gap_count, msc_gap_shift);
+   if(msc_aggr_count)
+      printf("msc aggregated       = %d (%d levels)\n", msc_aggr_count, msc_aggr_shift);
+
+   // terminate the last msc page
+   if(msc_out && msc_output())
+      msc_dump_stop(msc_fd, msc_level);
+   svg_close();
+
    // close opened files
-   if(msc_fd > 0)
+   if((msc_fd > 0) && msc_jobs)
    {
-      char cmd[512];
-      char basename[126];
-      int slen = string_len(msc_doc) - 1;
-      while(slen > 0)
-      {
-         if (msc_doc[slen] == '.')
-            break;
-         slen--;
-      }
-      if(slen > 0)
-      {
-         string_ncpy(basename, msc_doc, slen);
-         basename[slen] = 0;
-      }
-      else
-      {
-         string_cpy(basename, msc_doc);
-      }
+      msc_unit_close();
+      INFO("Found a maximum of %d instances in the whole document\n", msc_max_instances);
+      printf("msc paper size %dmm x %dmm\n", msc_paper_width(msc_max_instances), msc_paper_height());
 
-      if(msc_out)
-         msc_dump_stop(msc_fd, msc_level);
+      if(string_len(msc_cache) > 0)
+         printf("msc cache            = %d of %d units\n", msc_cache_hits, msc_unit);
+
+      // units have been compiled during the simulation
+      msc_merge();
+      INFO(".. done!\n");
+   }
+   else if(msc_fd > 0)
+   {
+      char cmd[512];
 
       msc_end_doc(msc_fd);
+      sink_close(msc_fd);
       INFO("Found a maximum of %d instances in the whole document\n", msc_max_instances);
 
       // compute the maximum number of levels per page
-      int msc_page_height = (msc_page_max_levels + 7) * msc_level_height;
-      int msc_page_width =  (msc_max_instances + 2 /*env left + env right */ - 1) * msc_inst_dist + 20 /* left + right margin */;
+      int msc_page_height = msc_paper_height();
+      int msc_page_width =  msc_paper_width(msc_max_instances);
 
-      // replace PAPERWIDTH and PAPERHEIGHT by the adequate value
-      string_printf(cmd, "sed 's/PAPERWIDTH/%d/g;s/PAPERHEIGHT/%d/g' /tmp/msc_doc > %s",
-                    msc_page_width, msc_page_height, msc_doc);
-      printf("%s\n", cmd);
-      system(cmd);
+      // write the paper size in the document header
+      printf("msc paper size %dmm x %dmm\n", msc_page_width, msc_page_height);
+      if(msc_set_geometry(msc_fd, msc_page_width, msc_page_height) < 0)
+         ERROR("Cannot write the paper size in %s\n", msc_doc);
       close(msc_fd);
 
-      INFO("make pdf latex %s.pdf ... \n", basename);
+      INFO("make pdf latex %s.pdf ... \n", msc_base);
       string_printf(cmd, "latex %s > /tmp/log", msc_doc);
       printf("%s\n", cmd);
       system(cmd);
 
-      string_printf(cmd, "dvipdf %s.dvi > /dev/null", basename);
+      string_printf(cmd, "dvipdf %s.dvi > /dev/null", msc_base);
       printf("%s\n", cmd);
       system(cmd);
-      INFO(".. done!\n", basename);
+      INFO(".. done!\n", msc_base);
    }
 
    if(sdl_fd > 0)
+   {
+      sink_close(sdl_fd);
       close(sdl_fd);
+   }
 
    if(vcd_fd > 0)
    {
-      close(vcd_fd);
+      sink_close(vcd_fd);
 
       if (vcd_fifo == 0)
       {
-         char cmd[512];
-
          // redraw instances
          vcd_write_definitions();
 
+         sink_close(vcd_def_fd);
+         INFO("copy definitions at the beginning of %s\n", vcd_doc);
+         if(vcd_assemble(vcd_doc) < 0)
+            ERROR("Cannot write definitions in %s\n", vcd_doc);
          close(vcd_def_fd);
-         INFO("concatenante def.vcd and sim.vcd\n");
-         string_printf(cmd, "cat /tmp/def.vcd /tmp/sim.vcd > %s\n", vcd_doc);
-         system(cmd);
       }
+
+      close(vcd_fd);
    }
 
-   // remove memory
+   // remove memory. The views are not followed anymore
+   rt_view_dirty = 1;
    for_each_object(&top, remove_iterator, NULL);
+   flush_graveyard();
+
+   if(rt_stats)
+   {
+      printf("compacted zombies    = %d\n", rt_graveyard_count);
+      heap_pool_dump(rt_event_pool);
+      heap_pool_dump(rt_object_pool);
+   }
+   heap_pool_destroy(rt_event_pool);
+   heap_pool_destroy(rt_object_pool);
+   heap_free(args);
 
    return 0;
 }
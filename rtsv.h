@@ -2,5 +2,6 @@
 #define RTSV_H
 
 #include <lib.h>
+#include "msc_svg.h"
 
 #endif